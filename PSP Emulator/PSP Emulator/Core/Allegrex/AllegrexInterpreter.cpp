@@ -806,15 +806,18 @@ void handleMemoryAccess(uint32_t opcode) {
 
     // static int ctr;
 
+    if (op < 0x28 || op == 0x31)
+        Core::Memory::checkReads(address, 4);
+
     switch (op) {
     case 0x20: value = *(int8_t *) addressPtr; break; // lb
     case 0x21: value = *(int16_t *)addressPtr; break; // lh
     case 0x23: value = *(uint32_t *)addressPtr; break; // lw
     case 0x24: value = *(uint8_t *)addressPtr; break; // lbu
     case 0x25: value = *(uint16_t *)addressPtr; break; // lhu
-    case 0x28: *(uint8_t *)addressPtr = value & 0xFF; break; // sb
-    case 0x29: *(uint16_t *)addressPtr = value & 0xFFFF; break; // sh
-    case 0x2B: *(uint32_t *)addressPtr = value; break; // sw
+    case 0x28: *(uint8_t *)addressPtr = value & 0xFF; Core::Memory::markPageWritten(address); break; // sb
+    case 0x29: *(uint16_t *)addressPtr = value & 0xFFFF; Core::Memory::markPageWritten(address); break; // sh
+    case 0x2B: *(uint32_t *)addressPtr = value; Core::Memory::markPageWritten(address); break; // sw
     case 0x22: case 0x26: case 0x2A: case 0x2E:
     {
         uint32_t shift = (address & 3) * 8;
@@ -850,7 +853,7 @@ void handleMemoryAccess(uint32_t opcode) {
         break;
     }
     case 0x31: fi[FT()] = *(uint32_t *)addressPtr; break;
-    case 0x39: *(uint32_t *)addressPtr = fi[FT()]; break;
+    case 0x39: *(uint32_t *)addressPtr = fi[FT()]; Core::Memory::markPageWritten(address); break;
     default:
         LOG_ERROR(logType, "unknown memory access opcode 0x%02x", op);
         setProcessorFailed(true);
@@ -793,13 +793,12 @@ bool handleSyscallFromAddress(uint32_t address) {
     }
     case 0x289D82FE: // sceDisplaySetFrameBuf
     {
-        reg[MIPS_REG_V0] = 0;
+        reg[MIPS_REG_V0] = sceDisplaySetFrameBuf(reg[MIPS_REG_A0], reg[MIPS_REG_A1], reg[MIPS_REG_A2], reg[MIPS_REG_A3]);
         return true;
     }
     case 0xEEDA2E54: // sceDisplayGetFrameBuf
     {
-        reg[MIPS_REG_V0] = 0;
-        LOG_WARN(logType, "unimplemented sceDisplayGetFrameBuf");
+        reg[MIPS_REG_V0] = sceDisplayGetFrameBuf(reg[MIPS_REG_A0], reg[MIPS_REG_A1], reg[MIPS_REG_A2], reg[MIPS_REG_A3]);
         return true;
     }
     case 0x8EB9EC49: // sceDisplayWaitVblankCB
@@ -825,12 +824,12 @@ bool handleSyscallFromAddress(uint32_t address) {
     }
     case 0x773DD3A3: // sceDisplayGetCurrentHcount
     {
-        reg[MIPS_REG_V0] = (Core::Timing::getCurrentCycles() % 3704040) / 272; // unimplemented
+        reg[MIPS_REG_V0] = sceDisplayGetCurrentHcount();
         return true;
     }
     case 0x9C6EAAD7: // sceDisplayGetVcount
     {
-        reg[MIPS_REG_V0] = (Core::Timing::getCurrentCycles() % 3704040) / 480; // unimplemented
+        reg[MIPS_REG_V0] = sceDisplayGetVcount();
         return true;
     }
 
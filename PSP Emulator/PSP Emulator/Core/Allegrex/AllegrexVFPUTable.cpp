@@ -69,10 +69,12 @@ enum VCondition
 
 namespace Core::Memory {
     void *GetPointerRange(uint32_t addr, int size) {
+        checkReads(addr, size);
         return getPointerUnchecked(addr);
     }
 
     void *GetPointerWriteRange(uint32_t addr, int size) {
+        markWritten(addr, size);
         return getPointerUnchecked(addr);
     }
 
@@ -82,8 +84,10 @@ namespace Core::Memory {
 
     void Write_Float(float data, uint32_t addr) {
         float *p = (float *) getPointer(addr);
-        if (p)
+        if (p) {
             *p = data;
+            markPageWritten(addr);
+        }
     }
 
     float Read_Float(uint32_t addr) {
@@ -79,6 +79,7 @@ bool reset() {
     frameCounter = 0;
 
     // resetting behaviours
+    Core::Timing::clearEvents();
     Core::GPU::reset();
     Core::Allegrex::resetState();
     Core::Utility::initRNG();
@@ -131,6 +132,7 @@ void step(uint64_t steps) {
 
 void frame() {
     step((uint64_t)Core::Timing::msToCycles(16.67));
+    Core::GPU::endFrame();
     // LOG_DEBUG(logType, "current frame %llu", ++frameCounter);
 }
 
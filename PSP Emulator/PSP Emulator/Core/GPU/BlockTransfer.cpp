@@ -0,0 +1,49 @@
+#include <Core/GPU/BlockTransfer.h>
+
+#include <Core/Memory/MemoryAccess.h>
+
+#include <Core/Logger.h>
+
+#include <cstring>
+
+namespace Core::GPU {
+static const char *logType = "gpu";
+
+bool __executeBlockTransfer(const GPUState::TransferInfo& info) {
+    uint32_t pixelSize = info.pixelSize;
+    uint32_t rowSize = info.width * pixelSize;
+    uint32_t sourceStride = info.sourceBufferWidth * pixelSize;
+    uint32_t destinationStride = info.destinationBufferWidth * pixelSize;
+
+    uint32_t source = info.sourceAddress + (info.sourceY * info.sourceBufferWidth + info.sourceX) * pixelSize;
+    uint32_t destination = info.destinationAddress + (info.destinationY * info.destinationBufferWidth + info.destinationX) * pixelSize;
+    uint32_t sourceSize = (info.height - 1) * sourceStride + rowSize;
+    uint32_t destinationSize = (info.height - 1) * destinationStride + rowSize;
+
+    if (!Memory::Utility::isValidAddressRange(source, source + sourceSize - 1) ||
+        !Memory::Utility::isValidAddressRange(destination, destination + destinationSize - 1)) {
+        LOG_ERROR(logType, "invalid block transfer 0x%08x -> 0x%08x (%dx%d, %d bytes per pixel)", source, destination,
+            info.width, info.height, pixelSize);
+        return false;
+    }
+
+    Memory::checkReads(source, sourceSize);
+
+    const uint8_t *in = (const uint8_t *) Memory::getPointerUnchecked(source);
+    uint8_t *out = (uint8_t *) Memory::getPointerUnchecked(destination);
+
+    if (sourceStride == rowSize && destinationStride == rowSize) {
+        std::memmove(out, in, sourceSize);
+    } else if (destination > source && destination < source + sourceSize) {
+        // the rectangles overlap with the destination further down, copy from the last row up
+        for (uint32_t y = info.height; y-- > 0;)
+            std::memmove(out + y * destinationStride, in + y * sourceStride, rowSize);
+    } else {
+        for (uint32_t y = 0; y < info.height; y++)
+            std::memmove(out + y * destinationStride, in + y * sourceStride, rowSize);
+    }
+
+    Memory::markWritten(destination, destinationSize);
+    return true;
+}
+}
\ No newline at end of file
@@ -0,0 +1,9 @@
+#pragma once
+
+#include <Core/GPU/GPU.h>
+
+namespace Core::GPU {
+// copies the transfer rectangle between guest buffers, the destination pages are marked
+// written so textures, palettes and framebuffers read from them are picked up again
+bool __executeBlockTransfer(const GPUState::TransferInfo& info);
+}
\ No newline at end of file
@@ -0,0 +1,162 @@
+#include <Core/GPU/GPU.h>
+#include <Core/GPU/ClearMode.h>
+#include <Core/GPU/GEConstants.h>
+#include <Core/GPU/PixelFormat.h>
+
+#include <Core/Memory/MemoryAccess.h>
+
+#include <Core/Utility/SIMD.h>
+
+#include <Core/Logger.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace Core::GPU {
+static const char *logType = "ClearMode";
+
+bool __getClearRectangle(const GPUState *state, int type, const DecodedVertexList& list, ClearRectangle& clear) {
+    // rectangles are expanded to their four corners on decode
+    if (!state->clearModeEnable || !state->vertexInfo.tm || type != GE_PRIM_RECTANGLES || list.indexType != 0 || list.vertices.size() != 4)
+        return false;
+
+    float minX = list.vertices[0].position.x, maxX = minX;
+    float minY = list.vertices[0].position.y, maxY = minY;
+    for (const VertexData& vertex : list.vertices) {
+        minX = std::min(minX, vertex.position.x);
+        maxX = std::max(maxX, vertex.position.x);
+        minY = std::min(minY, vertex.position.y);
+        maxY = std::max(maxY, vertex.position.y);
+    }
+
+    clear.x0 = std::max(int(minX), 0);
+    clear.y0 = std::max(int(minY), 0);
+    clear.x1 = int(maxX);
+    clear.y1 = int(maxY);
+
+    // the scissor is inclusive, an inverted one is left to the normal path. a rectangle
+    // entirely outside of it clears nothing
+    const GPUState::Scissor& scissor = state->scissor;
+    if (scissor.scissorUpperLeftX > scissor.scissorLowerRightX || scissor.scissorUpperLeftY > scissor.scissorLowerRightY)
+        return false;
+
+    clear.x0 = std::max<int>(clear.x0, scissor.scissorUpperLeftX);
+    clear.y0 = std::max<int>(clear.y0, scissor.scissorUpperLeftY);
+    clear.x1 = std::min<int>(clear.x1, scissor.scissorLowerRightX + 1);
+    clear.y1 = std::min<int>(clear.y1, scissor.scissorLowerRightY + 1);
+
+    const VertexData& vertex = list.vertices[0];
+    for (int i = 0; i < 4; i++)
+        clear.color[i] = state->vertexInfo.ct != 0 ? vertex.color[i] : state->materialAmbient[i];
+
+    clear.depth = uint16_t(std::clamp(vertex.position.z, 0.f, 65535.f));
+    clear.writeColor = state->clearColorMasked;
+    clear.writeAlpha = state->clearAlphaMasked;
+    clear.writeDepth = state->clearDepthMasked;
+    return true;
+}
+
+// value and mask hold the pixel repeated over 32 bits, the bits set in mask are replaced.
+// size is a multiple of 2 and p starts on a pixel
+static void __fillPixels(uint8_t *p, size_t size, uint32_t value, uint32_t mask) {
+    for (size_t i = 0; i + 2 <= size; i += 2) {
+        int shift = int(i & 2) * 8;
+        uint16_t v = uint16_t(value >> shift), m = uint16_t(mask >> shift), old;
+        std::memcpy(&old, p + i, 2);
+        old = uint16_t((old & ~m) | (v & m));
+        std::memcpy(p + i, &old, 2);
+    }
+}
+
+#if defined(SIMD_SSE2)
+static void __fillRow(uint8_t *row, size_t size, uint32_t value, uint32_t mask) {
+    const __m128i v = _mm_set1_epi32(int(value));
+    size_t i = 0;
+
+    if (mask == 0xFFFFFFFF) {
+        for (; i + 16 <= size; i += 16)
+            _mm_storeu_si128((__m128i *) (row + i), v);
+    } else {
+        const __m128i m = _mm_set1_epi32(int(mask));
+        const __m128i masked = _mm_and_si128(v, m);
+        for (; i + 16 <= size; i += 16) {
+            __m128i *p = (__m128i *) (row + i);
+            _mm_storeu_si128(p, _mm_or_si128(_mm_andnot_si128(m, _mm_loadu_si128(p)), masked));
+        }
+    }
+    __fillPixels(row + i, size - i, value, mask);
+}
+#else
+static void __fillRow(uint8_t *row, size_t size, uint32_t value, uint32_t mask) {
+    __fillPixels(row, size, value, mask);
+}
+#endif
+
+static void __fillBuffer(uint32_t address, uint32_t bufferWidth, uint32_t pixelSize, const ClearRectangle& clear, uint32_t value, uint32_t mask) {
+    int x1 = std::min<int>(clear.x1, bufferWidth);
+    if (mask == 0 || x1 <= clear.x0 || clear.y1 <= clear.y0)
+        return;
+
+    uint32_t stride = bufferWidth * pixelSize;
+    uint32_t rowSize = (x1 - clear.x0) * pixelSize;
+    uint32_t start = address + clear.y0 * stride + clear.x0 * pixelSize;
+    uint32_t end = start + (clear.y1 - clear.y0 - 1) * stride + rowSize;
+    if (!Core::Memory::Utility::isValidAddressRange(start, end - 1)) {
+        LOG_WARN(logType, "clear of 0x%08x-0x%08x is out of memory", start, end);
+        return;
+    }
+
+    uint8_t *row = (uint8_t *) Core::Memory::getPointerUnchecked(start);
+    for (int y = clear.y0; y < clear.y1; y++, row += stride)
+        __fillRow(row, rowSize, value, mask);
+
+    Core::Memory::markWritten(start, end - start);
+}
+
+void __clearFramebufferMemory(const GPUState *state, const ClearRectangle& clear) {
+    const GPUState::FramebufferInfo& framebuffer = state->framebufferInfo;
+    uint8_t rgba[4];
+    for (int i = 0; i < 4; i++)
+        rgba[i] = uint8_t(std::clamp(clear.color[i], 0.f, 1.f) * 255.f + .5f);
+
+    uint32_t color = rgba[0] | rgba[1] << 8 | rgba[2] << 16 | uint32_t(rgba[3]) << 24;
+    uint32_t value, colorMask, alphaMask;
+    switch (framebuffer.pixelFormat) {
+    case CMODE_FORMAT_32BIT_ABGR8888:
+        value = color;
+        colorMask = 0x00FFFFFF;
+        alphaMask = 0xFF000000;
+        break;
+    case CMODE_FORMAT_16BIT_BGR5650:
+        value = __packColor(color, framebuffer.pixelFormat);
+        colorMask = 0xFFFF;
+        alphaMask = 0;
+        break;
+    case CMODE_FORMAT_16BIT_ABGR5551:
+        value = __packColor(color, framebuffer.pixelFormat);
+        colorMask = 0x7FFF;
+        alphaMask = 0x8000;
+        break;
+    default:
+        value = __packColor(color, framebuffer.pixelFormat);
+        colorMask = 0x0FFF;
+        alphaMask = 0xF000;
+        break;
+    }
+
+    uint32_t pixelSize = __getPixelSize(framebuffer.pixelFormat);
+    if (pixelSize == 2) {
+        value |= value << 16;
+        colorMask |= colorMask << 16;
+        alphaMask |= alphaMask << 16;
+    }
+
+    uint32_t mask = (clear.writeColor ? colorMask : 0) | (clear.writeAlpha ? alphaMask : 0);
+    __fillBuffer(__getFramebufferAddress(framebuffer.address), framebuffer.bufferWidth, pixelSize, clear, value, mask);
+
+    if (clear.writeDepth) {
+        const GPUState::DepthBufferInfo& depthBuffer = state->depthBufferInfo;
+        __fillBuffer(__getFramebufferAddress(depthBuffer.address), depthBuffer.bufferWidth, 2, clear, clear.depth | uint32_t(clear.depth) << 16, 0xFFFFFFFF);
+    }
+}
+}
\ No newline at end of file
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+
+#include <Core/GPU/VertexDecoder.h>
+
+namespace Core::GPU {
+struct GPUState;
+
+// a clear mode rectangle reduced to the values it writes
+struct ClearRectangle {
+    int x0, y0, x1, y1; // in pixels with x1 and y1 exclusive, clipped to the scissor
+    float color[4];
+    uint16_t depth;
+    bool writeColor, writeAlpha, writeDepth; // alpha also carries the stencil
+};
+
+// true if the draw is a single through mode rectangle in clear mode, those don't need
+// the vertex pipeline and are turned into a clear of the framebuffer by the caller
+bool __getClearRectangle(const GPUState *state, int type, const DecodedVertexList& list, ClearRectangle& clear);
+
+// fills the framebuffer and depth buffer in VRAM, used when nothing renders on the host
+void __clearFramebufferMemory(const GPUState *state, const ClearRectangle& clear);
+}
\ No newline at end of file
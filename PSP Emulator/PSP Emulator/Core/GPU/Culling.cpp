@@ -0,0 +1,223 @@
+#include <Core/GPU/GPU.h>
+#include <Core/GPU/Culling.h>
+#include <Core/GPU/GEConstants.h>
+
+#include <Core/Utility/SIMD.h>
+
+#include <vector>
+#include <algorithm>
+
+namespace Core::GPU {
+static bool drawCullingEnable = true;
+static constexpr size_t compactionMinTriangles = 128; // smaller lists are only tested as a whole
+
+struct alignas(16) ClipVertex {
+    float x, y, z, w;
+};
+
+// v' = x * m[0..3] + y * m[4..7] + z * m[8..11] + w * m[12..15]
+static void __transformVector(const float m[16], const float v[4], float out[4]) {
+    for (int i = 0; i < 4; i++)
+        out[i] = v[0] * m[i] + v[1] * m[4 + i] + v[2] * m[8 + i] + v[3] * m[12 + i];
+}
+
+void __getClipMatrix(const GPUState *state, float clipMatrix[16]) {
+    // every column of the world matrix is carried through the view and the projection
+    for (int column = 0; column < 4; column++) {
+        float view[4];
+        __transformVector(state->viewMatrix.mData, state->worldMatrix.mData + column * 4, view);
+        __transformVector(state->projectionMatrix.mData, view, clipMatrix + column * 4);
+    }
+}
+
+#if defined(SIMD_SSE2)
+// clip coordinates and outcode of every vertex, returns the outcodes they share
+static uint32_t __transformClipVertices(const float clipMatrix[16], const VertexData *vertices, size_t count, ClipVertex *clip, uint8_t *outcodes) {
+    const __m128 column0 = _mm_loadu_ps(clipMatrix + 0);
+    const __m128 column1 = _mm_loadu_ps(clipMatrix + 4);
+    const __m128 column2 = _mm_loadu_ps(clipMatrix + 8);
+    const __m128 column3 = _mm_loadu_ps(clipMatrix + 12);
+    const __m128 signMask = _mm_set1_ps(-0.f);
+
+    uint32_t common = CLIP_LEFT | CLIP_BOTTOM | CLIP_NEAR | CLIP_RIGHT | CLIP_TOP;
+    for (size_t i = 0; i < count; i++) {
+        const glm::vec3& p = vertices[i].position;
+        __m128 position = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(p.x), column0), _mm_mul_ps(_mm_set1_ps(p.y), column1)),
+                                     _mm_add_ps(_mm_mul_ps(_mm_set1_ps(p.z), column2), column3));
+        _mm_store_ps(&clip[i].x, position);
+
+        __m128 w = _mm_shuffle_ps(position, position, _MM_SHUFFLE(3, 3, 3, 3));
+        uint32_t below = _mm_movemask_ps(_mm_cmplt_ps(position, _mm_xor_ps(w, signMask))) & 7;
+        uint32_t above = _mm_movemask_ps(_mm_cmpgt_ps(position, w)) & 3;
+        outcodes[i] = uint8_t(below | above << 4);
+        common &= outcodes[i];
+    }
+    return common;
+}
+
+uint32_t __getCommonClipOutcode(const float clipMatrix[16], const VertexData *vertices, size_t count) {
+    const __m128 column0 = _mm_loadu_ps(clipMatrix + 0);
+    const __m128 column1 = _mm_loadu_ps(clipMatrix + 4);
+    const __m128 column2 = _mm_loadu_ps(clipMatrix + 8);
+    const __m128 column3 = _mm_loadu_ps(clipMatrix + 12);
+    const __m128 signMask = _mm_set1_ps(-0.f);
+
+    uint32_t outcode = CLIP_LEFT | CLIP_BOTTOM | CLIP_NEAR | CLIP_RIGHT | CLIP_TOP;
+    for (size_t i = 0; i < count && outcode != 0; i++) {
+        const glm::vec3& p = vertices[i].position;
+        __m128 clip = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(p.x), column0), _mm_mul_ps(_mm_set1_ps(p.y), column1)),
+                                 _mm_add_ps(_mm_mul_ps(_mm_set1_ps(p.z), column2), column3));
+
+        // x, y and z against -w in the low nibble, x and y against w in the high one
+        __m128 w = _mm_shuffle_ps(clip, clip, _MM_SHUFFLE(3, 3, 3, 3));
+        uint32_t below = _mm_movemask_ps(_mm_cmplt_ps(clip, _mm_xor_ps(w, signMask))) & 7;
+        uint32_t above = _mm_movemask_ps(_mm_cmpgt_ps(clip, w)) & 3;
+        outcode &= below | above << 4;
+    }
+    return outcode;
+}
+#else
+static uint32_t __transformClipVertices(const float clipMatrix[16], const VertexData *vertices, size_t count, ClipVertex *clip, uint8_t *outcodes) {
+    uint32_t common = CLIP_LEFT | CLIP_BOTTOM | CLIP_NEAR | CLIP_RIGHT | CLIP_TOP;
+    for (size_t i = 0; i < count; i++) {
+        const glm::vec3& p = vertices[i].position;
+        const float position[4] = { p.x, p.y, p.z, 1.f };
+        ClipVertex& c = clip[i];
+        __transformVector(clipMatrix, position, &c.x);
+
+        uint32_t outcode = 0;
+        if (c.x < -c.w) outcode |= CLIP_LEFT;
+        if (c.y < -c.w) outcode |= CLIP_BOTTOM;
+        if (c.z < -c.w) outcode |= CLIP_NEAR;
+        if (c.x > c.w) outcode |= CLIP_RIGHT;
+        if (c.y > c.w) outcode |= CLIP_TOP;
+        outcodes[i] = uint8_t(outcode);
+        common &= outcode;
+    }
+    return common;
+}
+
+uint32_t __getCommonClipOutcode(const float clipMatrix[16], const VertexData *vertices, size_t count) {
+    uint32_t outcode = CLIP_LEFT | CLIP_BOTTOM | CLIP_NEAR | CLIP_RIGHT | CLIP_TOP;
+    for (size_t i = 0; i < count && outcode != 0; i++) {
+        const glm::vec3& p = vertices[i].position;
+        const float position[4] = { p.x, p.y, p.z, 1.f };
+        float clip[4];
+        __transformVector(clipMatrix, position, clip);
+
+        uint32_t vertexOutcode = 0;
+        if (clip[0] < -clip[3]) vertexOutcode |= CLIP_LEFT;
+        if (clip[1] < -clip[3]) vertexOutcode |= CLIP_BOTTOM;
+        if (clip[2] < -clip[3]) vertexOutcode |= CLIP_NEAR;
+        if (clip[0] > clip[3]) vertexOutcode |= CLIP_RIGHT;
+        if (clip[1] > clip[3]) vertexOutcode |= CLIP_TOP;
+        outcode &= vertexOutcode;
+    }
+    return outcode;
+}
+#endif
+
+bool __isBoundingBoxVisible(const GPUState *state, int count) {
+    if (state->vertexInfo.tm || count <= 0)
+        return true;
+
+    // indexed boxes test every vertex in the referenced range, which can only keep more visible
+    const DecodedVertexList *box = __getListFromVertexCache(state, GE_PRIM_POINTS, count);
+    if (!box || box->vertices.empty())
+        return true;
+
+    float clipMatrix[16];
+    __getClipMatrix(state, clipMatrix);
+    return __getCommonClipOutcode(clipMatrix, box->vertices.data(), box->vertices.size()) == 0;
+}
+
+// GL culls in window space, the viewport keeps the orientation of normalized device coordinates.
+// triangles crossing w = 0 flip there, they're left to the GPU
+static bool __isBackFacing(const ClipVertex& a, const ClipVertex& b, const ClipVertex& c, bool clockwise) {
+    if (a.w <= 0.f || b.w <= 0.f || c.w <= 0.f)
+        return false;
+
+    float ax = a.x / a.w, ay = a.y / a.w;
+    float area = (b.x / b.w - ax) * (c.y / c.w - ay) - (c.x / c.w - ax) * (b.y / b.w - ay);
+    return clockwise ? area >= 0.f : area <= 0.f;
+}
+
+CullResult __cullVertexList(const GPUState *state, int type, const DecodedVertexList& in, DecodedVertexList& out) {
+    if (!drawCullingEnable || state->vertexInfo.tm || state->clearModeEnable || in.vertices.empty())
+        return CULL_NONE;
+
+    float clipMatrix[16];
+    __getClipMatrix(state, clipMatrix);
+
+    const size_t vertexCount = in.vertices.size();
+    const size_t triangleCount = type == GE_PRIM_TRIANGLES ? (in.indexType != 0 ? size_t(in.indexCount) : vertexCount) / 3 : 0;
+    if (triangleCount < compactionMinTriangles)
+        return __getCommonClipOutcode(clipMatrix, in.vertices.data(), vertexCount) != 0 ? CULL_ALL : CULL_NONE;
+
+    static std::vector<ClipVertex> clip;
+    static std::vector<uint8_t> outcodes;
+    static std::vector<uint16_t> indices;
+    clip.resize(vertexCount);
+    outcodes.resize(vertexCount);
+
+    if (__transformClipVertices(clipMatrix, in.vertices.data(), vertexCount, clip.data(), outcodes.data()) != 0)
+        return CULL_ALL;
+
+    auto getIndex = [&](size_t i) -> uint32_t {
+        if (in.indexType == 1)
+            return in.indices[i];
+        if (in.indexType == 2)
+            return ((const uint16_t *) in.indices.data())[i];
+        return uint32_t(i);
+    };
+
+    // rectangles never reach here, their faces aren't culled either
+    const bool cullBackFaces = state->cullingEnable;
+    const bool clockwise = state->cullingFaceDirection;
+
+    indices.clear();
+    for (size_t t = 0; t < triangleCount; t++) {
+        uint32_t i0 = getIndex(t * 3), i1 = getIndex(t * 3 + 1), i2 = getIndex(t * 3 + 2);
+        if (i0 >= vertexCount || i1 >= vertexCount || i2 >= vertexCount)
+            return CULL_NONE;
+
+        if (outcodes[i0] & outcodes[i1] & outcodes[i2])
+            continue;
+        if (cullBackFaces && __isBackFacing(clip[i0], clip[i1], clip[i2], clockwise))
+            continue;
+        indices.insert(indices.end(), { uint16_t(i0), uint16_t(i1), uint16_t(i2) });
+    }
+
+    if (indices.empty())
+        return CULL_ALL;
+    // copying the list only pays off when a good part of it goes
+    if (indices.size() / 3 * 4 > triangleCount * 3)
+        return CULL_NONE;
+
+    out.indexCount = 0;
+    out.indices.clear();
+    if (in.indexType == 0) {
+        // unindexed lists keep only the vertices of the remaining triangles
+        out.vertices.resize(indices.size());
+        for (size_t i = 0; i < indices.size(); i++)
+            out.vertices[i] = in.vertices[indices[i]];
+        out.indexType = 0;
+        return CULL_COMPACTED;
+    }
+
+    out.vertices = in.vertices;
+    out.indices.resize(indices.size() * sizeof(uint16_t));
+    std::copy(indices.begin(), indices.end(), (uint16_t *) out.indices.data());
+    out.indexType = 2;
+    out.indexCount = int(indices.size());
+    return CULL_COMPACTED;
+}
+
+void setDrawCullingEnable(bool enable) {
+    drawCullingEnable = enable;
+}
+
+bool isDrawCullingEnabled() {
+    return drawCullingEnable;
+}
+}
\ No newline at end of file
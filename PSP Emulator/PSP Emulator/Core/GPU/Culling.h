@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <Core/GPU/VertexDecoder.h>
+
+namespace Core::GPU {
+struct GPUState;
+
+// one bit per clip plane a vertex lies outside of
+enum ClipOutcode : uint32_t {
+    CLIP_LEFT = 1 << 0,
+    CLIP_BOTTOM = 1 << 1,
+    CLIP_NEAR = 1 << 2,
+    CLIP_RIGHT = 1 << 4,
+    CLIP_TOP = 1 << 5,
+};
+
+// projection * view * world, column major like the matrices in GPUState
+void __getClipMatrix(const GPUState *state, float clipMatrix[16]);
+
+// outcodes shared by every vertex, non zero when they all lie outside the same plane.
+// the far plane isn't tested, the GE doesn't cull against it
+uint32_t __getCommonClipOutcode(const float clipMatrix[16], const VertexData *vertices, size_t count);
+
+// CMD_BBOX, tests the count vertices at the vertex list address. always visible in through mode
+bool __isBoundingBoxVisible(const GPUState *state, int count);
+
+enum CullResult {
+    CULL_NONE, // draw the list as it is
+    CULL_ALL, // nothing of the draw can be visible
+    CULL_COMPACTED, // draw the compacted copy instead
+};
+
+// pre-pass before submission, draws entirely outside the clip volume are rejected. large triangle
+// lists also have their off-screen and back facing triangles compacted out when enough of them go
+CullResult __cullVertexList(const GPUState *state, int type, const DecodedVertexList& in, DecodedVertexList& out);
+void setDrawCullingEnable(bool enable);
+bool isDrawCullingEnabled();
+}
\ No newline at end of file
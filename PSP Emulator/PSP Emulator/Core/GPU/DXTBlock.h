@@ -0,0 +1,177 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#include <Core/GPU/GEConstants.h>
+#include <Core/Utility/SIMD.h>
+
+// DXT block codec shared by the texture decoder and its tests
+namespace Core::GPU {
+// the PSP keeps the 2 bit color indices in front of the two colors, and DXT3/DXT5
+// store their alpha half after the color half, the reverse of the S3TC block layout
+#pragma pack(push, 1)
+struct DXT1Block {
+    uint8_t lines[4];
+    uint16_t color1, color2;
+};
+
+struct DXT3Block {
+    DXT1Block color;
+    uint16_t alphaLines[4];
+};
+
+struct DXT5Block {
+    DXT1Block color;
+    uint32_t alphaData2;
+    uint16_t alphaData1;
+    uint8_t alpha1, alpha2;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(DXT1Block) == 8 && sizeof(DXT3Block) == 16 && sizeof(DXT5Block) == 16, "invalid DXT block size");
+
+inline uint32_t __expandDXTColor(uint16_t c) {
+    uint32_t r = c >> 11, g = (c >> 5) & 0x3F, b = c & 0x1F;
+    r = (r << 3) | (r >> 2); g = (g << 2) | (g >> 4); b = (b << 3) | (b >> 2);
+    return r | (g << 8) | (b << 16) | 0xFF000000;
+}
+
+inline uint32_t __mixDXTColor(uint32_t c0, uint32_t c1, uint32_t w0, uint32_t w1, uint32_t div) {
+    uint32_t color = 0xFF000000;
+    for (int shift = 0; shift < 24; shift += 8)
+        color |= ((((c0 >> shift) & 0xFF) * w0 + ((c1 >> shift) & 0xFF) * w1) / div) << shift;
+    return color;
+}
+
+// DXT1 switches to three colors and transparent black when color1 <= color2,
+// DXT3 and DXT5 always use the four color mode
+inline void __buildDXTColors(const DXT1Block *block, uint32_t *colors, bool alphaMode) {
+    colors[0] = __expandDXTColor(block->color1);
+    colors[1] = __expandDXTColor(block->color2);
+
+    if (alphaMode && block->color1 <= block->color2) {
+        colors[2] = __mixDXTColor(colors[0], colors[1], 1, 1, 2);
+        colors[3] = 0;
+    } else {
+        colors[2] = __mixDXTColor(colors[0], colors[1], 2, 1, 3);
+        colors[3] = __mixDXTColor(colors[0], colors[1], 1, 2, 3);
+    }
+}
+
+inline void __buildDXT5Alphas(const DXT5Block *block, uint8_t *alphas) {
+    uint32_t a0 = block->alpha1, a1 = block->alpha2;
+    alphas[0] = a0;
+    alphas[1] = a1;
+
+    if (a0 > a1) {
+        for (uint32_t i = 2; i < 8; i++)
+            alphas[i] = uint8_t(((8 - i) * a0 + (i - 1) * a1) / 7);
+    } else {
+        for (uint32_t i = 2; i < 6; i++)
+            alphas[i] = uint8_t(((6 - i) * a0 + (i - 1) * a1) / 5);
+        alphas[6] = 0;
+        alphas[7] = 255;
+    }
+}
+
+// alpha of the 16 texels in row order, one byte each
+template<int _Format>
+inline void __decodeDXTAlphas(const uint8_t *in, uint8_t *out) {
+    if constexpr (_Format == GE_TFMT_DXT3) {
+        const DXT3Block *block = (const DXT3Block *) in;
+        for (int y = 0; y < 4; y++) {
+            for (int x = 0; x < 4; x++) {
+                uint32_t a = (block->alphaLines[y] >> (x * 4)) & 0xF;
+                out[y * 4 + x] = uint8_t(a | (a << 4));
+            }
+        }
+    } else {
+        const DXT5Block *block = (const DXT5Block *) in;
+        uint8_t alphas[8];
+        __buildDXT5Alphas(block, alphas);
+
+        uint64_t indices = block->alphaData2 | (uint64_t(block->alphaData1) << 32);
+        for (int i = 0; i < 16; i++, indices >>= 3)
+            out[i] = alphas[indices & 7];
+    }
+}
+
+#if defined(SIMD_SSSE3)
+// one pshufb expands a whole row of indices to colors, the masks are indexed by the row byte
+struct DXTShuffleMasks {
+    alignas(16) uint8_t row[256][16];
+    alignas(16) uint8_t alpha[4][16]; // moves the alphas of a row to the top byte of each texel
+
+    DXTShuffleMasks() {
+        for (int i = 0; i < 256; i++)
+            for (int x = 0; x < 4; x++)
+                for (int c = 0; c < 4; c++)
+                    row[i][x * 4 + c] = uint8_t(((i >> (x * 2)) & 3) * 4 + c);
+
+        for (int y = 0; y < 4; y++)
+            for (int x = 0; x < 16; x++)
+                alpha[y][x] = (x & 3) == 3 ? uint8_t(y * 4 + x / 4) : 0x80;
+    }
+};
+
+inline const DXTShuffleMasks dxtShuffleMasks;
+#endif
+
+template<int _Format>
+inline void __decodeDXTBlock(const uint8_t *in, uint32_t *out, int pitch) {
+    const DXT1Block *block = (const DXT1Block *) in;
+    alignas(16) uint32_t colors[4];
+    alignas(16) uint8_t alphas[16];
+
+    __buildDXTColors(block, colors, _Format == GE_TFMT_DXT1);
+    if constexpr (_Format != GE_TFMT_DXT1)
+        __decodeDXTAlphas<_Format>(in, alphas);
+
+#if defined(SIMD_SSSE3)
+    __m128i palette = _mm_load_si128((const __m128i *) colors);
+    __m128i alpha = _mm_load_si128((const __m128i *) alphas);
+    if constexpr (_Format != GE_TFMT_DXT1)
+        palette = _mm_and_si128(palette, _mm_set1_epi32(0x00FFFFFF));
+
+    for (int y = 0; y < 4; y++) {
+        __m128i row = _mm_shuffle_epi8(palette, _mm_load_si128((const __m128i *) dxtShuffleMasks.row[block->lines[y]]));
+        if constexpr (_Format != GE_TFMT_DXT1)
+            row = _mm_or_si128(row, _mm_shuffle_epi8(alpha, _mm_load_si128((const __m128i *) dxtShuffleMasks.alpha[y])));
+        _mm_storeu_si128((__m128i *) (out + y * pitch), row);
+    }
+#else
+    for (int y = 0; y < 4; y++) {
+        for (int x = 0; x < 4; x++) {
+            uint32_t color = colors[(block->lines[y] >> (x * 2)) & 3];
+            if constexpr (_Format != GE_TFMT_DXT1)
+                color = (color & 0x00FFFFFF) | (uint32_t(alphas[y * 4 + x]) << 24);
+            out[y * pitch + x] = color;
+        }
+    }
+#endif
+}
+
+// reorders a PSP block into the S3TC layout so it can be uploaded compressed
+template<int _Format>
+inline void __convertDXTBlock(const uint8_t *in, uint8_t *out) {
+    const DXT1Block *color = (const DXT1Block *) in;
+    uint8_t *colorOut = out;
+
+    if constexpr (_Format == GE_TFMT_DXT3) {
+        std::memcpy(out, ((const DXT3Block *) in)->alphaLines, 8);
+        colorOut = out + 8;
+    } else if constexpr (_Format == GE_TFMT_DXT5) {
+        const DXT5Block *block = (const DXT5Block *) in;
+        uint64_t indices = block->alphaData2 | (uint64_t(block->alphaData1) << 32);
+        out[0] = block->alpha1;
+        out[1] = block->alpha2;
+        std::memcpy(out + 2, &indices, 6);
+        colorOut = out + 8;
+    }
+
+    std::memcpy(colorOut + 0, &color->color1, 2);
+    std::memcpy(colorOut + 2, &color->color2, 2);
+    std::memcpy(colorOut + 4, color->lines, 4);
+}
+}
\ No newline at end of file
@@ -1,8 +1,12 @@
 #include <deque>
+#include <cstring>
 
 #include <Core/GPU/GPU.h>
 #include <Core/GPU/DisplayList.h>
 #include <Core/GPU/Renderer.h>
+#include <Core/GPU/TextureDecoder.h>
+#include <Core/GPU/BlockTransfer.h>
+#include <Core/GPU/GPUProfiler.h>
 
 #include <Core/GPU/GEConstants.h>
 
@@ -283,6 +287,17 @@ const char *getCommandName(uint8_t cmd) {
 
 #undef DO
 
+#define DO(name, value) case value: return true;
+
+bool isKnownCommand(uint8_t cmd) {
+    switch (cmd) {
+        X
+    }
+    return false;
+}
+
+#undef DO
+
 DisplayList *getDisplayListFromQueue(int qid) {
     for (auto& i : dlQueue) {
         if (qid = i.id)
@@ -316,6 +331,68 @@ DisplayList *getDisplayListFromQueue() {
 static int drawCount;
 static int primitiveDrawCount;
 
+// last instruction seen for every command, primitives are batched until a command
+// really changes the render state (games re-send identical state all the time)
+static uint32_t lastInstruction[256];
+
+static bool __flushesPrimitives(const GPUOpcode *opcode) {
+    switch (opcode->opcode) {
+    case CMD_NOP:
+    case CMD_VADDR:
+    case CMD_IADDR:
+    case CMD_PRIM:
+    case CMD_BASE:
+    case CMD_OFFSET:
+    case CMD_ORIGIN:
+    case CMD_JUMP:
+    case CMD_BBOX:
+    case CMD_BJUMP:
+    case CMD_CALL:
+    case CMD_RET:
+    case CMD_TFLUSH:
+    case CMD_TSYNC:
+        return false;
+    case CMD_BEZIER:
+    case CMD_SPLINE:
+    case CMD_END:
+    case CMD_SIGNAL:
+    case CMD_FINISH:
+    case CMD_XSTART:
+    // the data ports write the next matrix element, the same word can still change the state
+    case CMD_BONED:
+    case CMD_WORLDD:
+    case CMD_VIEWD:
+    case CMD_PROJD:
+    case CMD_TGEND:
+        return true;
+    }
+
+    if (lastInstruction[opcode->opcode] == opcode->instruction)
+        return false;
+
+    lastInstruction[opcode->opcode] = opcode->instruction;
+    return true;
+}
+
+void __resetCommandHistory() {
+    std::memset(lastInstruction, 0, sizeof lastInstruction);
+}
+
+// the next draw continues where the vertices or indices of the last one ended
+static void __advanceDrawAddress(GPUState *state, int count) {
+    switch (state->vertexInfo.it) {
+    case 0:
+        state->vertexListAddress += state->vertexInfo.vertex_size * count;
+        break;
+    case 1:
+        state->indexListAddress += count;
+        break;
+    case 2:
+        state->indexListAddress += 2 * count;
+        break;
+    }
+}
+
 bool displayListInStallAddress(const DisplayList *dl) {
     return dl->currentAddress == dl->stallAddress;
 }
@@ -349,9 +426,14 @@ void displayListRun(DisplayList *dl, int steps) {
 
         if (!opcode) {
             LOG_ERROR(logType, "invalid display list address 0x%08x", dl->currentAddress);
+            __FlushPrimitives(state);
             return;
         }
 
+        if (__flushesPrimitives(opcode))
+            __FlushPrimitives(state);
+
+        __profileCommand(opcode->opcode);
         switch (opcode->opcode) {
         case CMD_NOP: break;
         case CMD_VADDR:
@@ -363,21 +445,9 @@ void displayListRun(DisplayList *dl, int steps) {
             int count = opcode->parameter & 0xFFFF;
             int type = (opcode->parameter >> 16) & 7;
             
-            __PrepareDraw(state, type, count);
-            __DrawPrimitive(state, type, count);
-            __EndDraw(state);
-
-            switch (state->vertexInfo.it) {
-            case 0:
-                state->vertexListAddress += state->vertexInfo.vertex_size * count;
-                break;
-            case 1:
-                state->indexListAddress += count;
-                break;
-            case 2:
-                state->indexListAddress += 2 * count;
-                break;
-            }
+            __SubmitPrimitive(state, type, count);
+            __advanceDrawAddress(state, count);
+            __profileDraw(type, count);
 
             primitiveDrawCount += count;
             ++drawCount;
@@ -385,26 +455,39 @@ void displayListRun(DisplayList *dl, int steps) {
             break;
         }
         case CMD_BEZIER:
+        case CMD_SPLINE:
+        {
+            int ucount = opcode->parameter & 0xFF, vcount = (opcode->parameter >> 8) & 0xFF;
+            int count = ucount * vcount;
+
+            __SubmitPatch(state, opcode->opcode == CMD_SPLINE, opcode->parameter);
+            __advanceDrawAddress(state, count);
+            __profilePatch(opcode->opcode == CMD_SPLINE, ucount, vcount);
+
+            primitiveDrawCount += count;
+            ++drawCount;
+
             break;
+        }
         case CMD_JUMP:
         {
             state->jump(*dl, opcode->parameter);
             opcode = (GPUOpcode *) Memory::getPointerUnchecked(dl->currentAddress);
             continue;
         }
-#if 0
         case CMD_BBOX:
+            state->setBBOX(*dl, opcode->parameter);
+            __advanceDrawAddress(state, opcode->parameter & 0xFFFF);
             break;
         case CMD_BJUMP:
         {
-            state->jump(*dl, opcode->parameter);
-            opcode = ((GPUOpcode *) Memory::getPointerUnchecked(dl->currentAddress)) + 1;
-            dl->currentAddress += 4;
+            // the guarded draws are skipped without being decoded
+            if (!state->jumpBBOX(*dl, opcode->parameter))
+                break;
+
+            opcode = (GPUOpcode *) Memory::getPointerUnchecked(dl->currentAddress);
             continue;
         }
-        case CMD_SIGNAL:
-            break;
-#endif
         case CMD_CALL:
             state->call(*dl, opcode->parameter);
             opcode = (GPUOpcode *) Memory::getPointerUnchecked(dl->currentAddress);
@@ -491,10 +574,10 @@ void displayListRun(DisplayList *dl, int steps) {
         case CMD_MAA: state->setModelColorAlpha(opcode->parameter); break;
         case CMD_MK: state->setMK(opcode->parameter); break;
         case CMD_CULL: state->setCullingSurface(opcode->parameter); break;
-        case CMD_FBP: break;
-        case CMD_FBW: break;
-        case CMD_ZBP: break;
-        case CMD_ZBW: break;
+        case CMD_FBP: state->setFramebufferBasePointer(opcode->parameter); break;
+        case CMD_FBW: state->setFramebuuferBaseWidth(opcode->parameter); break;
+        case CMD_ZBP: state->setDepthbufferBasePointer(opcode->parameter); break;
+        case CMD_ZBW: state->setDepthbufferBaseWidth(opcode->parameter); break;
         case CMD_TBP0:
         case CMD_TBP1:
         case CMD_TBP2:
@@ -513,10 +596,10 @@ void displayListRun(DisplayList *dl, int steps) {
         case CMD_TBW7: state->setTextureBufferWidth(opcode->opcode - CMD_TBW0, opcode->parameter); break;
         case CMD_CBP: state->setCLUTBasePointer(opcode->parameter); break;
         case CMD_CBW: state->setUpperCLUTBasePointer(opcode->parameter); break;
-        case CMD_XBP1: break;
-        case CMD_XBPW1: break;
-        case CMD_XBP2: break;
-        case CMD_XBPW2: break;
+        case CMD_XBP1: state->setTransferSourceAddress(opcode->parameter); break;
+        case CMD_XBPW1: state->setTransferSourceBufferWidth(opcode->parameter); break;
+        case CMD_XBP2: state->setTransferDestinationAddress(opcode->parameter); break;
+        case CMD_XBPW2: state->setTransferDestinationBufferWidth(opcode->parameter); break;
         case CMD_TSIZE0:
         case CMD_TSIZE1:
         case CMD_TSIZE2:
@@ -529,7 +612,10 @@ void displayListRun(DisplayList *dl, int steps) {
         case CMD_TSHADE: state->setTextureShadeMapping(opcode->parameter); break;
         case CMD_TMODE: state->setTextureMode(opcode->parameter); break;
         case CMD_TPF: state->setTexturePixelFormat(opcode->parameter); break;
-        case CMD_CLOAD: state->setCLUTLoad(opcode->parameter); break;
+        case CMD_CLOAD:
+            state->setCLUTLoad(opcode->parameter);
+            __loadCLUT(state);
+            break;
         case CMD_CLUT: state->setCLUT(opcode->parameter); break;
         case CMD_TFILTER: state->setTextureFilter(opcode->parameter); break;
         case CMD_TWRAP: state->setTextureWrapMode(opcode->parameter); break;
@@ -544,8 +630,8 @@ void displayListRun(DisplayList *dl, int steps) {
         case CMD_TSLOPE: state->setTextureSlope(opcode->parameter); break;
         case CMD_FPF: state->setFramePixelFormat(opcode->parameter); break;
         case CMD_CMODE: state->setClearMode(opcode->parameter); break;
-        case CMD_SCISSOR1: state->setScissoringAreaLowerRight(opcode->parameter); break;
-        case CMD_SCISSOR2: state->setScissoringAreaUpperLeft(opcode->parameter); break;
+        case CMD_SCISSOR1: state->setScissoringAreaUpperLeft(opcode->parameter); break;
+        case CMD_SCISSOR2: state->setScissoringAreaLowerRight(opcode->parameter); break;
         case CMD_MINZ: state->setMinDepthRange(opcode->parameter); break;
         case CMD_MAXZ: state->setMaxDepthRange(opcode->parameter); break;
         case CMD_CTEST: state->setColorTestFunction(opcode->parameter); break;
@@ -558,11 +644,19 @@ void displayListRun(DisplayList *dl, int steps) {
         case CMD_BLEND: state->setBlend(opcode->parameter); break;
         case CMD_FIXA: state->setFixA(opcode->parameter); break;
         case CMD_FIXB: state->setFixB(opcode->parameter); break;
+        case CMD_XSTART:
+            state->setTransferPixelSize(opcode->parameter);
+            __executeBlockTransfer(state->transferInfo);
+            break;
+        case CMD_XPOS1: state->setTransferSourcePosition(opcode->parameter); break;
+        case CMD_XPOS2: state->setTransferDestinationPosition(opcode->parameter); break;
+        case CMD_XSIZE: state->setTransferSize(opcode->parameter); break;
         default:
             if (opcode->opcode < 0x17) {
                 LOG_ERROR(logType, "unimplemented GPU opcode 0x%02X (%s) instruction: 0x%08X list PC: 0x%08X", opcode->opcode, getCommandName(opcode->opcode),
                                                             opcode->instruction, dl->currentAddress);
                 Core::Allegrex::setProcessorFailed(true);
+                __FlushPrimitives(state);
                 return;
             }
             break;
@@ -571,5 +665,8 @@ void displayListRun(DisplayList *dl, int steps) {
         dl->currentAddress += 4;
         opcode++;
     }
+
+    // the guest may write vertex or texture memory before the list resumes
+    __FlushPrimitives(state);
 }
 }
\ No newline at end of file
@@ -13,6 +13,7 @@ struct DisplayList {
     uint32_t callStack[8];
     int callStackCurrentIndex;
     uint32_t state;
+    bool boundingBoxVisible; // result of the last CMD_BBOX, CMD_BJUMP jumps when it's false
 };
 
 DisplayList *getDisplayListFromQueue(int qid);
@@ -20,4 +21,7 @@ bool addDisplayListToQueue(const DisplayList& list);
 DisplayList *getDisplayListFromQueue();
 bool displayListInStallAddress(const DisplayList *dl);
 void displayListRun(DisplayList *dl, int steps = 10000000);
+const char *getCommandName(uint8_t cmd);
+bool isKnownCommand(uint8_t cmd);
+void __resetCommandHistory();
 }
\ No newline at end of file
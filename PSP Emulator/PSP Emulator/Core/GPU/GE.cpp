@@ -35,6 +35,7 @@ int sceGeListEnQueue(uint32_t listAddress, uint32_t stallAddress, int cbid, uint
     std::memset(dl.callStack, 0, sizeof dl.callStack);
     dl.callStackCurrentIndex = 0;
     dl.state = 1;
+    dl.boundingBoxVisible = true;
     addDisplayListToQueue(dl);
     LOG_SYSCALL(logType, "0x%08x %d = sceGeListEnQueue(list: 0x%08x, stall: 0x%08x, cbid: %d, args: 0x%08x)", Core::Allegrex::cpu.pc, dl.id, listAddress, stallAddress, cbid, argPtr);
     return dl.id;
@@ -1,4 +1,14 @@
 #include <Core/GPU/GPU.h>
+#include <Core/GPU/VertexDecoder.h>
+#include <Core/GPU/TextureDecoder.h>
+#include <Core/GPU/Tessellation.h>
+#include <Core/GPU/Culling.h>
+#include <Core/GPU/DisplayList.h>
+#include <Core/GPU/GPUProfiler.h>
+#include <Core/GPU/Renderer.h>
+#include <Core/GPU/sceDisplay.h>
+
+#include <Core/Utility/Arena.h>
 
 #include <Core/Logger.h>
 
@@ -19,8 +29,8 @@ void GPUState::draw(const DrawType& type, uint32_t param) {
 
 }
 
-void GPUState::setBBOX(uint32_t bboxParam) {
-
+void GPUState::setBBOX(DisplayList& dl, uint32_t bboxParam) {
+    dl.boundingBoxVisible = __isBoundingBoxVisible(this, bboxParam & 0xFFFF);
 }
 
 void GPUState::jump(DisplayList& dl, uint32_t param) {
@@ -28,8 +38,12 @@ void GPUState::jump(DisplayList& dl, uint32_t param) {
     dl.currentAddress = jumpAddress + offsetAddress;
 }
 
-void GPUState::jumpBBOX(DisplayList& dl, uint32_t param) {
+bool GPUState::jumpBBOX(DisplayList& dl, uint32_t param) {
+    if (dl.boundingBoxVisible)
+        return false;
 
+    jump(dl, param);
+    return true;
 }
 
 bool GPUState::call(DisplayList& dl, uint32_t param) {
@@ -238,15 +252,16 @@ void GPUState::setVertexWeight(int weightNr, uint32_t param) {
 }
 
 void GPUState::setPatchDivisionCount(uint32_t count) {
-
+    patchInfo.divisionS = count & 0x7F;
+    patchInfo.divisionT = (count >> 8) & 0x7F;
 }
 
 void GPUState::setPatchPrimitive(uint32_t param) {
-
+    patchInfo.primitive = param & 3;
 }
 
 void GPUState::setPatchFace(uint32_t param) {
-
+    patchInfo.face = bool(param & 1);
 }
 
 void GPUState::setWorldMatrixNumber(uint32_t param) {
@@ -454,19 +469,21 @@ void GPUState::setCullingSurface(uint32_t param) {
 }
 
 void GPUState::setFramebufferBasePointer(uint32_t param) {
-
+    framebufferInfo.address = (framebufferInfo.address & 0xFF000000) | (param & 0xFFFFF0);
 }
 
 void GPUState::setFramebuuferBaseWidth(uint32_t param) {
-
+    framebufferInfo.address = (framebufferInfo.address & 0xFFFFFF) | ((param << 8) & 0xFF000000);
+    framebufferInfo.bufferWidth = param & 0x7C0;
 }
 
 void GPUState::setDepthbufferBasePointer(uint32_t param) {
-
+    depthBufferInfo.address = (depthBufferInfo.address & 0xFF000000) | (param & 0xFFFFF0);
 }
 
 void GPUState::setDepthbufferBaseWidth(uint32_t param) {
-
+    depthBufferInfo.address = (depthBufferInfo.address & 0xFFFFFF) | ((param << 8) & 0xFF000000);
+    depthBufferInfo.bufferWidth = param & 0x7C0;
 }
 
 void GPUState::setTextureBufferBasePointer(int level, uint32_t param) {
@@ -489,6 +506,47 @@ void GPUState::setUpperCLUTBasePointer(uint32_t param) {
     clutAddress = (clutAddress & 0x00FFFFFF) | ((param << 8) & 0x0F000000);
 }
 
+void GPUState::setTransferSourceAddress(uint32_t param) {
+    uint32_t& sourceAddress = transferInfo.sourceAddress;
+    sourceAddress = (sourceAddress & 0xFF000000) | (param & 0x00FFFFF0);
+}
+
+void GPUState::setTransferSourceBufferWidth(uint32_t param) {
+    uint32_t& sourceAddress = transferInfo.sourceAddress;
+    sourceAddress = (sourceAddress & 0x00FFFFFF) | ((param << 8) & 0xFF000000);
+    transferInfo.sourceBufferWidth = param & 0x7F8;
+}
+
+void GPUState::setTransferDestinationAddress(uint32_t param) {
+    uint32_t& destinationAddress = transferInfo.destinationAddress;
+    destinationAddress = (destinationAddress & 0xFF000000) | (param & 0x00FFFFF0);
+}
+
+void GPUState::setTransferDestinationBufferWidth(uint32_t param) {
+    uint32_t& destinationAddress = transferInfo.destinationAddress;
+    destinationAddress = (destinationAddress & 0x00FFFFFF) | ((param << 8) & 0xFF000000);
+    transferInfo.destinationBufferWidth = param & 0x7F8;
+}
+
+void GPUState::setTransferSourcePosition(uint32_t param) {
+    transferInfo.sourceX = param & 0x3FF;
+    transferInfo.sourceY = (param >> 10) & 0x3FF;
+}
+
+void GPUState::setTransferDestinationPosition(uint32_t param) {
+    transferInfo.destinationX = param & 0x3FF;
+    transferInfo.destinationY = (param >> 10) & 0x3FF;
+}
+
+void GPUState::setTransferSize(uint32_t param) {
+    transferInfo.width = (param & 0x3FF) + 1;
+    transferInfo.height = ((param >> 10) & 0x3FF) + 1;
+}
+
+void GPUState::setTransferPixelSize(uint32_t param) {
+    transferInfo.pixelSize = (param & 1) ? 4 : 2;
+}
+
 void GPUState::setTextureSize(int level, uint32_t param) {
     int textureWidth = 1 << (param & 0xF);
     int textureHeight = 1 << ((param >> 8) & 0xF);
@@ -574,7 +632,7 @@ void GPUState::setTextureSlope(uint32_t param) {
 }
 
 void GPUState::setFramePixelFormat(uint32_t param) {
-
+    framebufferInfo.pixelFormat = param & 3;
 }
 
 void GPUState::setClearMode(uint32_t param) {
@@ -654,6 +712,7 @@ void initialize() {
         return;
 
     std::memset(gpu, 0, sizeof *gpu);
+    __displayInitialize();
     LOG_SUCCESS(logType, "initialized gpu");
 }
 
@@ -665,6 +724,11 @@ void reset() {
 
     gpu = new GPUState;
     std::memset(gpu, 0, sizeof *gpu);
+    __clearVertexCache();
+    __clearTessellationCache();
+    __clearCLUTCache();
+    __resetCommandHistory();
+    __displayInitialize();
     LOG_SUCCESS(logType, "restarted gpu");
 }
 
@@ -674,6 +738,19 @@ void destroy() {
         gpu = nullptr;
     }
 
+    __clearVertexCache();
+    __clearTessellationCache();
+    __clearCLUTCache();
+    __displayShutdown();
     LOG_SUCCESS(logType, "destroyed gpu");
 }
+
+void endFrame() {
+    __updateVertexCache();
+    __updateTessellationCache();
+    __RenderDeviceEndFrame();
+    Core::Utility::resetFrameArenas();
+    __prefetchTextures();
+    __profilerEndFrame();
+}
 }
\ No newline at end of file
@@ -214,6 +214,32 @@ public:
         uint16_t scissorLowerRightX, scissorLowerRightY;
     } scissor;
 
+    struct TransferInfo {
+        uint32_t sourceAddress, destinationAddress;
+        uint32_t sourceBufferWidth, destinationBufferWidth; // in pixels
+        uint32_t sourceX, sourceY;
+        uint32_t destinationX, destinationY;
+        uint32_t width, height;
+        uint32_t pixelSize; // 2 or 4 bytes
+    } transferInfo;
+
+    struct FramebufferInfo {
+        uint32_t address; // low 24 bits from FBP, the high byte from FBW
+        uint32_t bufferWidth; // in pixels
+        uint32_t pixelFormat;
+    } framebufferInfo;
+
+    struct DepthBufferInfo {
+        uint32_t address; // low 24 bits from ZBP, the high byte from ZBW
+        uint32_t bufferWidth; // in pixels, depth is always 16-bit
+    } depthBufferInfo;
+
+    struct PatchInfo {
+        uint8_t divisionS, divisionT; // segments every patch is split into along u and v
+        uint8_t primitive; // 0 triangles, 1 lines, 2 points
+        bool face; // reverses the winding of generated triangles
+    } patchInfo;
+
     float minZ, maxZ;
     uint8_t alphaTestFunction;
     uint8_t alphaTestColorReference;
@@ -238,9 +264,9 @@ public:
     void setIndexListAddress(uint32_t param);
     void setVertexListAddress(uint32_t param);
     void draw(const DrawType& type, uint32_t param);
-    void setBBOX(uint32_t bboxParam);
+    void setBBOX(DisplayList& dl, uint32_t bboxParam);
     void jump(DisplayList& dl, uint32_t param);
-    void jumpBBOX(DisplayList& dl, uint32_t param);
+    bool jumpBBOX(DisplayList& dl, uint32_t param);
     bool call(DisplayList& dl, uint32_t param);
     bool ret(DisplayList& dl, uint32_t param);
     void end(uint32_t param);
@@ -323,6 +349,14 @@ public:
     void setTextureBufferWidth(int level, uint32_t param);
     void setCLUTBasePointer(uint32_t param);
     void setUpperCLUTBasePointer(uint32_t param);
+    void setTransferSourceAddress(uint32_t param);
+    void setTransferSourceBufferWidth(uint32_t param);
+    void setTransferDestinationAddress(uint32_t param);
+    void setTransferDestinationBufferWidth(uint32_t param);
+    void setTransferSourcePosition(uint32_t param);
+    void setTransferDestinationPosition(uint32_t param);
+    void setTransferSize(uint32_t param);
+    void setTransferPixelSize(uint32_t param);
     void setTextureSize(int level, uint32_t param);
     void setTextureMappingMode(uint32_t param);
     void setTextureShadeMapping(uint32_t param);
@@ -364,4 +398,5 @@ GPUState *getGPUState();
 void initialize();
 void reset();
 void destroy();
+void endFrame();
 }
\ No newline at end of file
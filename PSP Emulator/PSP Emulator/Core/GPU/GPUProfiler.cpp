@@ -0,0 +1,156 @@
+#include <Core/GPU/GPUProfiler.h>
+#include <Core/GPU/DisplayList.h>
+#include <Core/GPU/GEConstants.h>
+
+#include <Core/Logger.h>
+
+#include <fstream>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+
+namespace Core::GPU {
+static const char *logType = "GPUProfiler";
+
+bool profilerEnabled;
+GPUFrameStatistics profilerFrame;
+
+static GPUFrameStatistics lastFrame;
+static uint64_t profilerFrameNumber;
+static std::ofstream csvFile;
+static std::vector<int> csvCommands; // opcodes with a name get a column
+
+static const char *drawTypeNames[PROFILER_DRAW_TYPE_COUNT] = {
+    "points", "lines", "line_strip", "triangles", "triangle_strip", "triangle_fan", "rectangles", "repeat", "bezier", "spline"
+};
+
+static const char *stageNames[PROFILER_STAGE_COUNT] = { "decode", "skinning", "submit" };
+
+static int __getPrimitiveCount(int type, int vertexCount) {
+    switch (type) {
+    case GE_PRIM_POINTS: return vertexCount;
+    case GE_PRIM_LINES: return vertexCount / 2;
+    case GE_PRIM_LINE_STRIP: return std::max(vertexCount - 1, 0);
+    case GE_PRIM_TRIANGLES: return vertexCount / 3;
+    case GE_PRIM_TRIANGLE_STRIP:
+    case GE_PRIM_TRIANGLE_FAN: return std::max(vertexCount - 2, 0);
+    case GE_PRIM_RECTANGLES: return vertexCount / 2;
+    }
+    return 0;
+}
+
+static void __recordDraw(int drawType, int vertexCount, int primitiveCount) {
+    profilerFrame.draws[drawType]++;
+    profilerFrame.vertices[drawType] += vertexCount;
+    profilerFrame.primitives[drawType] += primitiveCount;
+}
+
+void setGPUProfilerEnable(bool enable) {
+    if (enable && !profilerEnabled) {
+        std::memset(&profilerFrame, 0, sizeof profilerFrame);
+        profilerFrame.frame = profilerFrameNumber;
+    }
+    profilerEnabled = enable;
+}
+
+bool isGPUProfilerEnabled() {
+    return profilerEnabled;
+}
+
+const GPUFrameStatistics& getGPUFrameStatistics() {
+    return lastFrame;
+}
+
+bool openGPUProfilerCSV(const char *file) {
+    closeGPUProfilerCSV();
+
+    csvFile.open(file, std::ios::out | std::ios::trunc);
+    if (!csvFile.is_open()) {
+        LOG_ERROR(logType, "can't open profiler output %s", file);
+        return false;
+    }
+
+    csvCommands.clear();
+    for (int i = 0; i < 256; i++) {
+        if (isKnownCommand(uint8_t(i)))
+            csvCommands.push_back(i);
+    }
+
+    csvFile << "frame";
+    for (const char *name : drawTypeNames)
+        csvFile << ",draws_" << name << ",vertices_" << name << ",primitives_" << name;
+    csvFile << ",texture_hits,texture_misses,texture_bytes_decoded,vertex_hits,vertex_misses";
+    for (const char *name : stageNames)
+        csvFile << "," << name << "_ms";
+    for (int opcode : csvCommands)
+        csvFile << "," << getCommandName(uint8_t(opcode));
+    csvFile << "\n";
+    return true;
+}
+
+void closeGPUProfilerCSV() {
+    if (csvFile.is_open())
+        csvFile.close();
+}
+
+static void __writeCSVRow(const GPUFrameStatistics& statistics) {
+    csvFile << statistics.frame;
+    for (int i = 0; i < PROFILER_DRAW_TYPE_COUNT; i++)
+        csvFile << "," << statistics.draws[i] << "," << statistics.vertices[i] << "," << statistics.primitives[i];
+    csvFile << "," << statistics.textureCacheHits << "," << statistics.textureCacheMisses << "," << statistics.textureBytesDecoded
+            << "," << statistics.vertexCacheHits << "," << statistics.vertexCacheMisses;
+    for (int i = 0; i < PROFILER_STAGE_COUNT; i++)
+        csvFile << "," << statistics.stageTime[i];
+    for (int opcode : csvCommands)
+        csvFile << "," << statistics.commands[opcode];
+    csvFile << "\n";
+}
+
+void __profilerEndFrame() {
+    profilerFrameNumber++;
+    if (!profilerEnabled)
+        return;
+
+    lastFrame = profilerFrame;
+    if (csvFile.is_open())
+        __writeCSVRow(lastFrame);
+
+    std::memset(&profilerFrame, 0, sizeof profilerFrame);
+    profilerFrame.frame = profilerFrameNumber;
+}
+
+void __profileDraw(int type, int vertexCount) {
+    if (profilerEnabled)
+        __recordDraw(type & 7, vertexCount, __getPrimitiveCount(type, vertexCount));
+}
+
+void __profilePatch(bool spline, int ucount, int vcount) {
+    if (!profilerEnabled)
+        return;
+
+    int patches = spline ? std::max(ucount - 3, 0) * std::max(vcount - 3, 0) : std::max(ucount - 1, 0) / 3 * (std::max(vcount - 1, 0) / 3);
+    __recordDraw(spline ? PROFILER_DRAW_SPLINE : PROFILER_DRAW_BEZIER, ucount * vcount, patches);
+}
+
+void __profileTextureCache(bool hit, size_t bytesDecoded) {
+    if (!profilerEnabled)
+        return;
+
+    if (hit) {
+        profilerFrame.textureCacheHits++;
+    } else {
+        profilerFrame.textureCacheMisses++;
+        profilerFrame.textureBytesDecoded += bytesDecoded;
+    }
+}
+
+void __profileVertexCache(bool hit) {
+    if (!profilerEnabled)
+        return;
+
+    if (hit)
+        profilerFrame.vertexCacheHits++;
+    else
+        profilerFrame.vertexCacheMisses++;
+}
+}
\ No newline at end of file
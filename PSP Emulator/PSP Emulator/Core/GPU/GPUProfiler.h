@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <chrono>
+
+namespace Core::GPU {
+enum ProfilerStage : int {
+    PROFILER_STAGE_DECODE, // vertices, textures and patches
+    PROFILER_STAGE_SKINNING,
+    PROFILER_STAGE_SUBMIT, // the render device preparing and issuing draws
+    PROFILER_STAGE_COUNT
+};
+
+// draws are counted by GE primitive type, curved surfaces follow the primitive types
+enum ProfilerDrawType : int {
+    PROFILER_DRAW_BEZIER = 8,
+    PROFILER_DRAW_SPLINE = 9,
+    PROFILER_DRAW_TYPE_COUNT
+};
+
+struct GPUFrameStatistics {
+    uint64_t frame;
+    uint32_t commands[256]; // executed GE commands by opcode
+    uint32_t draws[PROFILER_DRAW_TYPE_COUNT];
+    uint32_t vertices[PROFILER_DRAW_TYPE_COUNT];
+    uint32_t primitives[PROFILER_DRAW_TYPE_COUNT];
+    uint32_t textureCacheHits, textureCacheMisses;
+    uint64_t textureBytesDecoded;
+    uint32_t vertexCacheHits, vertexCacheMisses;
+    double stageTime[PROFILER_STAGE_COUNT]; // in milliseconds
+};
+
+extern bool profilerEnabled;
+extern GPUFrameStatistics profilerFrame; // the frame being counted
+
+void setGPUProfilerEnable(bool enable);
+bool isGPUProfilerEnabled();
+const GPUFrameStatistics& getGPUFrameStatistics(); // the last completed frame
+
+// every frame completed while the file is open is written as one row
+bool openGPUProfilerCSV(const char *file);
+void closeGPUProfilerCSV();
+
+void __profilerEndFrame();
+void __profileDraw(int type, int vertexCount);
+void __profilePatch(bool spline, int ucount, int vcount);
+void __profileTextureCache(bool hit, size_t bytesDecoded);
+void __profileVertexCache(bool hit);
+
+// runs for every GE command, only this one is kept inline
+inline void __profileCommand(uint8_t opcode) {
+    if (profilerEnabled)
+        profilerFrame.commands[opcode]++;
+}
+
+// adds the time until it goes out of scope to a stage
+class ProfilerScope {
+private:
+    ProfilerStage stage;
+    bool active;
+    std::chrono::steady_clock::time_point start;
+public:
+    explicit ProfilerScope(ProfilerStage stage) : stage(stage), active(profilerEnabled) {
+        if (active)
+            start = std::chrono::steady_clock::now();
+    }
+
+    ~ProfilerScope() {
+        if (active)
+            profilerFrame.stageTime[stage] += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+};
+}
\ No newline at end of file
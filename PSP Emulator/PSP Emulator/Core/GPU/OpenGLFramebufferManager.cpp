@@ -0,0 +1,406 @@
+#include <Core/GPU/OpenGLFramebufferManager.h>
+#include <Core/GPU/OpenGLState.h>
+#include <Core/GPU/GEConstants.h>
+#include <Core/GPU/PixelFormat.h>
+
+#include <Core/Memory/MemoryAccess.h>
+
+#include <Core/Utility/SIMD.h>
+
+#include <Core/Logger.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace Core::GPU {
+static const char *logType = "Renderer";
+
+#if defined(SIMD_SSE2)
+static inline __m128i __shiftMask(__m128i c, int shift, int mask) {
+    return _mm_and_si128(_mm_srl_epi32(c, _mm_cvtsi32_si128(shift)), _mm_set1_epi32(mask));
+}
+
+// same as __packColor for 4 pixels, the results stay in the low half of each lane
+static inline __m128i __packColors(__m128i c, uint32_t pixelFormat) {
+    switch (pixelFormat) {
+    case CMODE_FORMAT_16BIT_BGR5650:
+        return _mm_or_si128(_mm_or_si128(__shiftMask(c, 3, 0x1F), __shiftMask(c, 5, 0x7E0)), __shiftMask(c, 8, 0xF800));
+    case CMODE_FORMAT_16BIT_ABGR5551:
+        return _mm_or_si128(_mm_or_si128(__shiftMask(c, 3, 0x1F), __shiftMask(c, 6, 0x3E0)),
+            _mm_or_si128(__shiftMask(c, 9, 0x7C00), __shiftMask(c, 16, 0x8000)));
+    default:
+        return _mm_or_si128(_mm_or_si128(__shiftMask(c, 4, 0xF), __shiftMask(c, 8, 0xF0)),
+            _mm_or_si128(__shiftMask(c, 12, 0xF00), __shiftMask(c, 16, 0xF000)));
+    }
+}
+#endif
+
+// RGBA8888 back to the framebuffer format
+static void __convertFromRGBA(const uint32_t *in, uint8_t *out, int count, uint32_t pixelFormat) {
+    if (pixelFormat == CMODE_FORMAT_32BIT_ABGR8888) {
+        std::memcpy(out, in, count * sizeof(uint32_t));
+        return;
+    }
+
+    uint16_t *out16 = (uint16_t *) out;
+    int i = 0;
+#if defined(SIMD_SSE2)
+    for (; i + 8 <= count; i += 8) {
+        __m128i lo = __packColors(_mm_loadu_si128((const __m128i *) (in + i)), pixelFormat);
+        __m128i hi = __packColors(_mm_loadu_si128((const __m128i *) (in + i + 4)), pixelFormat);
+
+        // sign extended first so the saturating pack keeps all 16 bits
+        lo = _mm_srai_epi32(_mm_slli_epi32(lo, 16), 16);
+        hi = _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16);
+        _mm_storeu_si128((__m128i *) (out16 + i), _mm_packs_epi32(lo, hi));
+    }
+#endif
+    for (; i < count; i++)
+        out16[i] = __packColor(in[i], pixelFormat);
+}
+
+static OpenGLFramebufferManager *readbackManager;
+
+static void __readbackWatchedTargets(uint32_t address, uint32_t size) {
+    if (readbackManager)
+        readbackManager->readback(address, size);
+}
+
+uint32_t RenderTarget::getByteSize() const {
+    return bufferWidth * __getPixelSize(pixelFormat) * OpenGLFramebufferManager::targetHeight;
+}
+
+OpenGLFramebufferManager::OpenGLFramebufferManager() {
+    glState = nullptr;
+    boundTarget = nullptr;
+    lastTarget = nullptr;
+    renderScale = 1;
+    frame = 1;
+    nextReadback = 0;
+    readbackFBO = 0;
+    readbackTexture = 0;
+    std::memset(readbacks, 0, sizeof readbacks);
+}
+
+void OpenGLFramebufferManager::create(OpenGLState *_glState, int _renderScale) {
+    glState = _glState;
+    renderScale = _renderScale;
+
+    for (auto& readback : readbacks) {
+        glGenBuffers(1, &readback.pbo);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.pbo);
+        glBufferData(GL_PIXEL_PACK_BUFFER, targetWidth * targetHeight * sizeof(uint32_t), nullptr, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    glGenTextures(1, &readbackTexture);
+    glState->bindTexture(readbackTexture);
+    glState->textureParameters2D(GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE, GL_NEAREST, GL_NEAREST);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, targetWidth, targetHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+    glGenFramebuffers(1, &readbackFBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, readbackFBO);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, readbackTexture, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    readbackManager = this;
+    Core::Memory::setReadWatchHandler(__readbackWatchedTargets);
+}
+
+void OpenGLFramebufferManager::destroy() {
+    if (readbackManager == this) {
+        Core::Memory::setReadWatchHandler(nullptr);
+        readbackManager = nullptr;
+    }
+
+    targetLRU.clear();
+    for (auto& i : targets) {
+        releaseTarget(&i.second);
+        deleteTarget(&i.second);
+    }
+
+    targets.clear();
+    boundTarget = nullptr;
+    lastTarget = nullptr;
+
+    for (auto& readback : readbacks) {
+        if (readback.fence)
+            glDeleteSync(readback.fence);
+        glDeleteBuffers(1, &readback.pbo);
+    }
+    std::memset(readbacks, 0, sizeof readbacks);
+
+    glDeleteFramebuffers(1, &readbackFBO);
+    glState->deleteTexture(readbackTexture);
+    readbackFBO = readbackTexture = 0;
+}
+
+// VRAM keeps whatever it had when a drawn target goes away
+void OpenGLFramebufferManager::releaseTarget(RenderTarget *target) {
+    if (target->vramDirty) {
+        Core::Memory::unwatchReads(target->address, target->getByteSize());
+        target->vramDirty = false;
+    }
+
+    for (auto& readback : readbacks) {
+        if (readback.target == target)
+            readback.target = nullptr;
+    }
+}
+
+void OpenGLFramebufferManager::deleteTarget(RenderTarget *target) {
+    glState->deleteTexture(target->colorTexture);
+    glDeleteRenderbuffers(1, &target->depthStencil);
+    glDeleteFramebuffers(1, &target->fbo);
+}
+
+RenderTarget *OpenGLFramebufferManager::createTarget(uint64_t key, uint32_t address, uint32_t bufferWidth, uint32_t pixelFormat) {
+    RenderTarget target {};
+
+    // every target has the same size so the least recently used one hands over its GL objects
+    if (targets.size() >= maxRenderTargets) {
+        RenderTarget *victim = targetLRU.leastRecentlyUsed();
+        LOG_DEBUG(logType, "recycling render target 0x%08x for 0x%08x", victim->address, address);
+
+        target.fbo = victim->fbo;
+        target.colorTexture = victim->colorTexture;
+        target.depthStencil = victim->depthStencil;
+
+        if (boundTarget == victim)
+            boundTarget = nullptr;
+        if (lastTarget == victim)
+            lastTarget = nullptr;
+
+        releaseTarget(victim);
+        targetLRU.remove(victim);
+        targets.erase(uint64_t(victim->address) << 32 | victim->bufferWidth << 8 | victim->pixelFormat);
+        glBindFramebuffer(GL_FRAMEBUFFER, target.fbo);
+    } else {
+        GLsizei width = targetWidth * renderScale, height = targetHeight * renderScale;
+
+        glGenTextures(1, &target.colorTexture);
+        glState->bindTexture(target.colorTexture);
+        glState->textureParameters2D(GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE, GL_NEAREST, GL_NEAREST);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+        glGenRenderbuffers(1, &target.depthStencil);
+        glBindRenderbuffer(GL_RENDERBUFFER, target.depthStencil);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+
+        glGenFramebuffers(1, &target.fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, target.fbo);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, target.colorTexture, 0);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, target.depthStencil);
+
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            LOG_ERROR(logType, "render target 0x%08x is incomplete", address);
+    }
+
+    glClearColor(0.f, 0.f, 0.f, 0.f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+    boundTarget = nullptr; // the viewport wasn't set up yet
+
+    target.address = address;
+    target.bufferWidth = bufferWidth;
+    target.pixelFormat = pixelFormat;
+
+    RenderTarget *newTarget = &(targets[key] = target);
+    LOG_DEBUG(logType, "created render target 0x%08x width %d format %d (%zu targets)", address, bufferWidth, pixelFormat, targets.size());
+    return newTarget;
+}
+
+RenderTarget *OpenGLFramebufferManager::bind(const GPUState::FramebufferInfo& info) {
+    uint32_t address = __getFramebufferAddress(info.address);
+    uint64_t key = uint64_t(address) << 32 | info.bufferWidth << 8 | info.pixelFormat;
+
+    RenderTarget *target;
+    if (auto it = targets.find(key); it != targets.end())
+        target = &it->second;
+    else
+        target = createTarget(key, address, info.bufferWidth, info.pixelFormat);
+
+    targetLRU.touch(target);
+    target->lastRenderedFrame = frame;
+    target->writeStamp = Core::Memory::takeWriteStamp();
+    target->drawGeneration++;
+    lastTarget = target;
+
+    if (!target->vramDirty) {
+        target->vramDirty = true;
+        Core::Memory::watchReads(target->address, target->getByteSize());
+    }
+
+    if (boundTarget != target) {
+        glBindFramebuffer(GL_FRAMEBUFFER, target->fbo);
+        glViewport(0, 0, targetWidth * renderScale, targetHeight * renderScale);
+        boundTarget = target;
+    }
+    return target;
+}
+
+void OpenGLFramebufferManager::invalidateBinding() {
+    boundTarget = nullptr;
+}
+
+void OpenGLFramebufferManager::endFrame() {
+    frame++;
+
+    // targets the CPU looked at before are likely read again, their pixels are on the way by then
+    int started = 0;
+    for (auto& i : targets) {
+        RenderTarget& target = i.second;
+        if (started < readbackCount && target.vramDirty && target.readbackRequested && !findReadback(&target)) {
+            startReadback(&target);
+            started++;
+        }
+    }
+}
+
+OpenGLFramebufferManager::Readback *OpenGLFramebufferManager::findReadback(const RenderTarget *target) {
+    for (auto& readback : readbacks) {
+        if (readback.target == target && readback.drawGeneration == target->drawGeneration)
+            return &readback;
+    }
+    return nullptr;
+}
+
+OpenGLFramebufferManager::Readback *OpenGLFramebufferManager::startReadback(RenderTarget *target) {
+    Readback *readback = &readbacks[nextReadback];
+    nextReadback = (nextReadback + 1) % readbackCount;
+
+    if (readback->fence)
+        glDeleteSync(readback->fence);
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, target->fbo);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, readbackFBO);
+    glBlitFramebuffer(0, 0, targetWidth * renderScale, targetHeight * renderScale, 0, 0, targetWidth, targetHeight, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, readbackFBO);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback->pbo);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, targetWidth, targetHeight, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    readback->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    readback->target = target;
+    readback->drawGeneration = target->drawGeneration;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, boundTarget ? boundTarget->fbo : 0);
+    return readback;
+}
+
+void OpenGLFramebufferManager::finishReadback(Readback *readback) {
+    RenderTarget *target = readback->target;
+
+    // only waits when nothing was read back ahead of time
+    if (readback->fence) {
+        GLenum result;
+        do {
+            result = glClientWaitSync(readback->fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+        } while (result == GL_TIMEOUT_EXPIRED);
+
+        glDeleteSync(readback->fence);
+        readback->fence = nullptr;
+    }
+
+    uint32_t byteSize = target->getByteSize();
+    uint8_t *out = (uint8_t *) Core::Memory::getPointerUnchecked(target->address);
+    if (!out || !Core::Memory::getPointerUnchecked(target->address + byteSize - 1)) {
+        LOG_ERROR(logType, "render target 0x%08x doesn't fit in VRAM", target->address);
+        out = nullptr;
+    }
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback->pbo);
+    const uint32_t *pixels = (const uint32_t *) glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, targetWidth * targetHeight * sizeof(uint32_t), GL_MAP_READ_BIT);
+    if (pixels) {
+        uint32_t rowBytes = target->bufferWidth * __getPixelSize(target->pixelFormat);
+        int width = std::min<int>(targetWidth, target->bufferWidth);
+
+        // GL rows are bottom-up
+        for (int y = 0; out && y < targetHeight; y++)
+            __convertFromRGBA(pixels + (targetHeight - 1 - y) * targetWidth, out + y * rowBytes, width, target->pixelFormat);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    readback->target = nullptr;
+
+    releaseTarget(target);
+    Core::Memory::markWritten(target->address, byteSize);
+    target->writeStamp = Core::Memory::takeWriteStamp(); // the written back pixels are still the GPU copy's
+}
+
+void OpenGLFramebufferManager::readback(uint32_t address, uint32_t size) {
+    for (auto& i : targets) {
+        RenderTarget& target = i.second;
+        if (!target.vramDirty || address >= target.address + target.getByteSize() || address + size <= target.address)
+            continue;
+
+        target.readbackRequested = true;
+        Readback *readback = findReadback(&target);
+        finishReadback(readback ? readback : startReadback(&target));
+    }
+}
+
+RenderTarget *OpenGLFramebufferManager::getDisplayTarget(uint32_t address) {
+    address = __getFramebufferAddress(address);
+
+    RenderTarget *displayTarget = nullptr;
+    for (auto& i : targets) {
+        RenderTarget& target = i.second;
+        if (target.address == address && (!displayTarget || target.lastRenderedFrame > displayTarget->lastRenderedFrame))
+            displayTarget = &target;
+    }
+    return displayTarget ? displayTarget : lastTarget;
+}
+
+RenderTarget *OpenGLFramebufferManager::getTextureTarget(const GPUState *state, int& offsetX, int& offsetY) {
+    const GPUState::TextureInfo& info = state->textureInfo;
+
+    // only direct color textures can be the same pixels the GE rendered
+    if (targets.empty() || info.textureStorage > GE_TFMT_8888)
+        return nullptr;
+
+    uint32_t textureAddress = info.textureBasePointer[0] & 0x0FFFFFFF;
+    if (textureAddress < 0x04000000 || textureAddress >= 0x04800000)
+        return nullptr;
+
+    textureAddress = 0x04000000 | (textureAddress & 0x1FFFFF);
+    uint32_t drawAddress = __getFramebufferAddress(state->framebufferInfo.address);
+
+    RenderTarget *textureTarget = nullptr;
+    for (auto& i : targets) {
+        RenderTarget& target = i.second;
+
+        // a target can't be sampled while it's drawn to
+        if (target.address == drawAddress || target.pixelFormat != info.textureStorage || target.bufferWidth != info.textureBufferWidth[0])
+            continue;
+
+        if (textureAddress < target.address || textureAddress >= target.address + target.getByteSize())
+            continue;
+
+        if (!textureTarget || target.lastRenderedFrame > textureTarget->lastRenderedFrame)
+            textureTarget = &target;
+    }
+
+    if (!textureTarget)
+        return nullptr;
+
+    // the CPU replaced the pixels after the GE drew them, VRAM is the newer copy then
+    uint32_t pixelSize = __getPixelSize(textureTarget->pixelFormat);
+    uint32_t textureSize = info.textureBufferWidth[0] * info.textureHeight[0] * pixelSize;
+    if (Core::Memory::isWrittenSince(textureAddress, textureSize, textureTarget->writeStamp))
+        return nullptr;
+
+    uint32_t offset = textureAddress - textureTarget->address;
+    uint32_t rowBytes = textureTarget->bufferWidth * pixelSize;
+    int x = int(offset % rowBytes / pixelSize), y = int(offset / rowBytes);
+
+    // targets only hold the display size, anything sampled past it is decoded from VRAM
+    if (x + int(info.textureWidth[0]) > targetWidth || y + int(info.textureHeight[0]) > targetHeight)
+        return nullptr;
+
+    offsetX = x;
+    offsetY = y;
+    return textureTarget;
+}
+}
\ No newline at end of file
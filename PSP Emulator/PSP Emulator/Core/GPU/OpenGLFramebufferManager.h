@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+
+#include <GL/glew.h>
+
+#include <Core/GPU/GPU.h>
+#include <Core/Kernel/LRU.h>
+
+namespace Core::GPU {
+class OpenGLState;
+
+// host copy of a GE framebuffer, every target covers the display size at the render scale
+struct RenderTarget {
+    uint32_t address; // VRAM address
+    uint32_t bufferWidth;
+    uint32_t pixelFormat;
+    GLuint fbo, colorTexture, depthStencil;
+    uint64_t lastRenderedFrame;
+    uint64_t writeStamp; // memory write stamp taken at the last draw, later CPU writes make the VRAM copy newer
+    uint64_t drawGeneration; // bumped by every draw
+    bool vramDirty; // drawn to since VRAM was last written back, its pages are read watched
+    bool readbackRequested; // read by the CPU before, written back asynchronously at the end of each frame
+    Core::DS::LRUNode lruNode;
+
+    uint32_t getByteSize() const;
+};
+
+// one render target per (address, format, stride), when too many are alive the least recently
+// used one is recycled. textures pointing into a target are sampled from its color texture.
+// VRAM is only brought up to date when something reads a drawn target's pages, through a ring
+// of pixel pack buffers. targets read once are read back at every frame end without waiting,
+// so the next read usually finds the pixels ready
+class OpenGLFramebufferManager {
+private:
+    static constexpr size_t maxRenderTargets = 16;
+    static constexpr int readbackCount = 3;
+
+    struct Readback {
+        GLuint pbo;
+        GLsync fence;
+        RenderTarget *target;
+        uint64_t drawGeneration; // of the target when the pixels were read
+    };
+
+    std::unordered_map<uint64_t, RenderTarget> targets;
+    Core::DS::LRU<RenderTarget, &RenderTarget::lruNode> targetLRU;
+    OpenGLState *glState;
+    RenderTarget *boundTarget;
+    RenderTarget *lastTarget; // most recently drawn to
+    int renderScale;
+    uint64_t frame;
+
+    Readback readbacks[readbackCount];
+    int nextReadback;
+    GLuint readbackFBO, readbackTexture; // targets are scaled down to the PSP resolution in here
+
+    RenderTarget *createTarget(uint64_t key, uint32_t address, uint32_t bufferWidth, uint32_t pixelFormat);
+    void deleteTarget(RenderTarget *target);
+    void releaseTarget(RenderTarget *target);
+
+    Readback *findReadback(const RenderTarget *target);
+    Readback *startReadback(RenderTarget *target);
+    void finishReadback(Readback *readback);
+public:
+    static constexpr int targetWidth = 480, targetHeight = 272;
+
+    OpenGLFramebufferManager();
+
+    void create(OpenGLState *glState, int renderScale);
+    void destroy();
+
+    RenderTarget *bind(const GPUState::FramebufferInfo& info); // makes the target the draw framebuffer
+    void invalidateBinding(); // has to be called when another framebuffer was bound
+    void endFrame();
+
+    // target shown for the display framebuffer, the last drawn one when nothing was drawn there
+    RenderTarget *getDisplayTarget(uint32_t address);
+    // target the bound texture lies in, offsetX and offsetY are where it starts in pixels
+    RenderTarget *getTextureTarget(const GPUState *state, int& offsetX, int& offsetY);
+
+    // writes every drawn target overlapping the range back to VRAM
+    void readback(uint32_t address, uint32_t size);
+
+    int getRenderScale() const { return renderScale; }
+    size_t getTargetCount() const { return targets.size(); }
+};
+}
\ No newline at end of file
@@ -0,0 +1,243 @@
+#include <Core/GPU/OpenGLShaderCache.h>
+#include <Core/GPU/OpenGLState.h>
+#include <Core/GPU/GPU.h>
+
+#include <Core/Utility/Hash.h>
+
+#include <Core/Logger.h>
+
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <vector>
+#include <cstdio>
+
+namespace Core::GPU {
+static const char *logType = "Renderer";
+
+struct ShaderBinaryHeader {
+    uint32_t magic;
+    uint32_t id;
+    uint64_t sourceHash;
+    uint32_t format;
+    uint32_t size;
+};
+
+static constexpr uint32_t shaderBinaryMagic = 0x42535741; // AWSB
+
+static bool __readShaderSource(const char *file, std::string& source) {
+    std::ifstream inputFile(file, std::ios::binary);
+    if (!inputFile.is_open()) {
+        LOG_ERROR(logType, "error opening shader file %s", file);
+        return false;
+    }
+
+    std::stringstream stream;
+    stream << inputFile.rdbuf();
+    source = stream.str();
+    return true;
+}
+
+static bool __compileShader(GLuint shader, const std::string& source, const std::string& defines) {
+    // the defines have to follow the #version line
+    size_t versionEnd = source.find('\n');
+    std::string variantSource = versionEnd == std::string::npos ? source + "\n" + defines :
+        source.substr(0, versionEnd + 1) + defines + source.substr(versionEnd + 1);
+
+    const char *sourcePointer = variantSource.c_str();
+    glShaderSource(shader, 1, &sourcePointer, nullptr);
+    glCompileShader(shader);
+
+    int success, type;
+    char infoLog[512];
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        glGetShaderiv(shader, GL_SHADER_TYPE, &type);
+        glGetShaderInfoLog(shader, 512, NULL, infoLog);
+        LOG_ERROR(logType, "%s Shader failed: %s", type == GL_VERTEX_SHADER ? "Vertex" : "Fragment", infoLog);
+        return false;
+    }
+    return true;
+}
+
+OpenGLShaderCache::OpenGLShaderCache() {
+    glState = nullptr;
+    sourceHash = 0;
+    useBinaries = false;
+}
+
+bool OpenGLShaderCache::create(OpenGLState *_glState, const char *vertexShaderFile, const char *fragmentShaderFile, const char *_binaryDirectory) {
+    glState = _glState;
+    if (!__readShaderSource(vertexShaderFile, vertexSource) || !__readShaderSource(fragmentShaderFile, fragmentSource))
+        return false;
+
+    // binaries are only valid for the same sources on the same driver
+    const char *renderer = (const char *) glGetString(GL_RENDERER);
+    const char *version = (const char *) glGetString(GL_VERSION);
+    std::string driver = std::string(renderer ? renderer : "") + (version ? version : "");
+
+    sourceHash = Utility::hash64(vertexSource.data(), vertexSource.size());
+    sourceHash = Utility::hashCombine(sourceHash, Utility::hash64(fragmentSource.data(), fragmentSource.size()));
+    sourceHash = Utility::hashCombine(sourceHash, Utility::hash64(driver.data(), driver.size()));
+
+    useBinaries = false;
+    if (_binaryDirectory && GLEW_ARB_get_program_binary) {
+        GLint formats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+
+        std::error_code error;
+        std::filesystem::create_directories(_binaryDirectory, error);
+        if (formats > 0 && !error) {
+            binaryDirectory = _binaryDirectory;
+            useBinaries = true;
+        }
+    }
+    return true;
+}
+
+void OpenGLShaderCache::destroy() {
+    for (auto& i : programs) {
+        if (i.second.program)
+            glState->deleteProgram(i.second.program);
+    }
+    programs.clear();
+}
+
+std::string OpenGLShaderCache::getBinaryPath(uint32_t id) const {
+    char name[32];
+    snprintf(name, sizeof name, "/%08x.shadercache", id);
+    return binaryDirectory + name;
+}
+
+GLuint OpenGLShaderCache::compileProgram(uint32_t id) {
+    std::string defines;
+    if (id & SHADER_THROUGH_MODE)
+        defines += "#define THROUGH_MODE\n";
+    if (id & SHADER_TEXTURE)
+        defines += "#define TEXTURE\n";
+    if (id & SHADER_VERTEX_COLOR)
+        defines += "#define VERTEX_COLOR\n";
+
+    GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
+    GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+    GLuint program = 0;
+
+    if (__compileShader(vertexShader, vertexSource, defines) && __compileShader(fragmentShader, fragmentSource, defines)) {
+        program = glCreateProgram();
+        if (useBinaries)
+            glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
+        glAttachShader(program, vertexShader);
+        glAttachShader(program, fragmentShader);
+        glLinkProgram(program);
+
+        int success;
+        char infoLog[512];
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+        if (!success) {
+            glGetProgramInfoLog(program, 512, NULL, infoLog);
+            LOG_ERROR(logType, "Link Failed: %s", infoLog);
+            glDeleteProgram(program);
+            program = 0;
+        }
+    }
+
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+    return program;
+}
+
+GLuint OpenGLShaderCache::loadProgramBinary(uint32_t id) {
+    std::ifstream inputFile(getBinaryPath(id), std::ios::binary);
+    if (!inputFile.is_open())
+        return 0;
+
+    ShaderBinaryHeader header;
+    if (!inputFile.read((char *) &header, sizeof header) || header.magic != shaderBinaryMagic || header.id != id || header.sourceHash != sourceHash)
+        return 0;
+
+    std::vector<uint8_t> binary(header.size);
+    if (!inputFile.read((char *) binary.data(), binary.size()))
+        return 0;
+
+    GLuint program = glCreateProgram();
+    glProgramBinary(program, header.format, binary.data(), (GLsizei) binary.size());
+
+    // drivers reject binaries after an update, the variant is compiled again then
+    int success;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+void OpenGLShaderCache::saveProgramBinary(uint32_t id, GLuint program) {
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+
+    std::vector<uint8_t> binary(length);
+    GLenum format;
+    glGetProgramBinary(program, length, &length, &format, binary.data());
+
+    ShaderBinaryHeader header { .magic = shaderBinaryMagic, .id = id, .sourceHash = sourceHash, .format = format, .size = (uint32_t) length };
+    std::ofstream outputFile(getBinaryPath(id), std::ios::binary);
+    if (!outputFile.is_open()) {
+        LOG_WARN(logType, "can't write shader binary %s", getBinaryPath(id).c_str());
+        return;
+    }
+
+    outputFile.write((const char *) &header, sizeof header);
+    outputFile.write((const char *) binary.data(), length);
+}
+
+ShaderProgram *OpenGLShaderCache::getProgram(uint32_t id) {
+    if (auto it = programs.find(id); it != programs.end())
+        return it->second.program ? &it->second : nullptr;
+
+    GLuint program = useBinaries ? loadProgramBinary(id) : 0;
+    if (!program) {
+        program = compileProgram(id);
+        if (program && useBinaries)
+            saveProgramBinary(id, program);
+    }
+
+    // failed variants are remembered too so they aren't rebuilt for every draw
+    ShaderProgram& entry = programs[id];
+    entry = ShaderProgram {};
+    entry.program = program;
+    entry.id = id;
+    if (!program) {
+        LOG_ERROR(logType, "can't build shader variant 0x%08x", id);
+        return nullptr;
+    }
+
+    entry.uProjectionIndex = glGetUniformLocation(program, "uProjection");
+    entry.uViewIndex = glGetUniformLocation(program, "uView");
+    entry.uWorldIndex = glGetUniformLocation(program, "uWorld");
+    entry.uBoneIndex = glGetUniformLocation(program, "uBone");
+    entry.textureScaleXIndex = glGetUniformLocation(program, "textureScaleX");
+    entry.textureScaleYIndex = glGetUniformLocation(program, "textureScaleY");
+    entry.materialAmbientIndex = glGetUniformLocation(program, "materialAmbient");
+    entry.textureTransformIndex = glGetUniformLocation(program, "textureTransform");
+
+    LOG_DEBUG(logType, "built shader variant 0x%08x (%zu variants)", id, programs.size());
+    return &entry;
+}
+
+uint32_t __getShaderID(const GPUState *state, bool hasTexture) {
+    uint32_t id = 0;
+
+    if (state->vertexInfo.tm)
+        id |= SHADER_THROUGH_MODE;
+    // clear mode only writes the vertex color
+    if (hasTexture && !state->clearModeEnable)
+        id |= SHADER_TEXTURE;
+    if (state->vertexInfo.ct != 0)
+        id |= SHADER_VERTEX_COLOR;
+    return id;
+}
+}
\ No newline at end of file
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+#include <GL/glew.h>
+
+namespace Core::GPU {
+struct GPUState;
+class OpenGLState;
+
+// pipeline state a shader variant is specialised on, packed into its id
+enum ShaderFeature : uint32_t {
+    SHADER_THROUGH_MODE = 1 << 0,
+    SHADER_TEXTURE = 1 << 1,
+    SHADER_VERTEX_COLOR = 1 << 2,
+};
+
+struct ShaderProgram {
+    GLuint program;
+    uint32_t id;
+    uint64_t matrixGeneration; // matrices last uploaded to this program
+    GLint uProjectionIndex, uViewIndex, uWorldIndex, uBoneIndex;
+    GLint textureScaleXIndex, textureScaleYIndex;
+    GLint materialAmbientIndex;
+    GLint textureTransformIndex;
+};
+
+// variants are built from one source pair with the features #define'd after the #version
+// line, they're compiled on first use and kept as program binaries on disk when the driver can
+class OpenGLShaderCache {
+private:
+    OpenGLState *glState;
+    std::string vertexSource, fragmentSource;
+    uint64_t sourceHash;
+    std::string binaryDirectory;
+    bool useBinaries;
+    std::unordered_map<uint32_t, ShaderProgram> programs;
+
+    GLuint compileProgram(uint32_t id);
+    GLuint loadProgramBinary(uint32_t id);
+    void saveProgramBinary(uint32_t id, GLuint program);
+    std::string getBinaryPath(uint32_t id) const;
+public:
+    OpenGLShaderCache();
+
+    // binaryDirectory can be nullptr to only cache in memory
+    bool create(OpenGLState *glState, const char *vertexShaderFile, const char *fragmentShaderFile, const char *binaryDirectory);
+    void destroy();
+
+    ShaderProgram *getProgram(uint32_t id); // nullptr if the variant failed to build
+    size_t getProgramCount() const { return programs.size(); }
+};
+
+uint32_t __getShaderID(const GPUState *state, bool hasTexture);
+}
\ No newline at end of file
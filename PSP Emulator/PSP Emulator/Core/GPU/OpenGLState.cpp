@@ -0,0 +1,186 @@
+#include <Core/GPU/OpenGLState.h>
+
+namespace Core::GPU {
+OpenGLState::OpenGLState() {
+    invalidate();
+}
+
+void OpenGLState::invalidate() {
+    for (auto& i : capabilities)
+        i = -1;
+
+    blendFuncValid = frontFaceValid = depthRangeValid = false;
+    programValid = textureValid = false;
+    // uniform values belong to the program objects, they stay valid whatever is bound in between
+    programUniforms = nullptr;
+}
+
+int OpenGLState::getCapabilityIndex(GLenum capability) {
+    switch (capability) {
+    case GL_BLEND: return CAPABILITY_BLEND;
+    case GL_DEPTH_TEST: return CAPABILITY_DEPTH_TEST;
+    case GL_CULL_FACE: return CAPABILITY_CULL_FACE;
+    }
+    return -1;
+}
+
+void OpenGLState::enable(GLenum capability, bool enabled) {
+    int index = getCapabilityIndex(capability);
+    if (index != -1) {
+        if (capabilities[index] == (int8_t) enabled)
+            return;
+        capabilities[index] = (int8_t) enabled;
+    }
+
+    if (enabled)
+        glEnable(capability);
+    else
+        glDisable(capability);
+}
+
+void OpenGLState::blendFunc(GLenum source, GLenum destination) {
+    if (blendFuncValid && blendSource == source && blendDestination == destination)
+        return;
+
+    blendFuncValid = true;
+    blendSource = source;
+    blendDestination = destination;
+    glBlendFunc(source, destination);
+}
+
+void OpenGLState::frontFace(GLenum mode) {
+    if (frontFaceValid && frontFaceMode == mode)
+        return;
+
+    frontFaceValid = true;
+    frontFaceMode = mode;
+    glFrontFace(mode);
+}
+
+void OpenGLState::depthRange(GLdouble zNear, GLdouble zFar) {
+    if (depthRangeValid && depthNear == zNear && depthFar == zFar)
+        return;
+
+    depthRangeValid = true;
+    depthNear = zNear;
+    depthFar = zFar;
+    glDepthRange(zNear, zFar);
+}
+
+void OpenGLState::useProgram(GLuint _program) {
+    if (programValid && program == _program)
+        return;
+
+    programValid = true;
+    program = _program;
+    programUniforms = &uniforms[_program];
+    glUseProgram(_program);
+}
+
+void OpenGLState::deleteProgram(GLuint _program) {
+    if (!_program)
+        return;
+
+    // GL may hand the name out again, the new program starts without any values
+    if (programValid && program == _program) {
+        programValid = false;
+        programUniforms = nullptr;
+    }
+
+    uniforms.erase(_program);
+    glDeleteProgram(_program);
+}
+
+void OpenGLState::bindTexture(GLuint _texture) {
+    if (textureValid && texture == _texture)
+        return;
+
+    textureValid = true;
+    texture = _texture;
+    glBindTexture(GL_TEXTURE_2D, _texture);
+}
+
+void OpenGLState::deleteTexture(GLuint _texture) {
+    if (!_texture)
+        return;
+
+    // GL unbinds a deleted texture and may hand its name out again
+    if (textureValid && texture == _texture)
+        texture = 0;
+
+    textureParameters.erase(_texture);
+    glDeleteTextures(1, &_texture);
+}
+
+void OpenGLState::textureParameters2D(GLint wrapS, GLint wrapT, GLint magFilter, GLint minFilter) {
+    if (!textureValid) {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrapS);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrapT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, magFilter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, minFilter);
+        return;
+    }
+
+    auto it = textureParameters.find(texture);
+    TextureParameters *parameters = it != textureParameters.end() ? &it->second : nullptr;
+
+    if (!parameters || parameters->wrapS != wrapS)
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrapS);
+    if (!parameters || parameters->wrapT != wrapT)
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrapT);
+    if (!parameters || parameters->magFilter != magFilter)
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, magFilter);
+    if (!parameters || parameters->minFilter != minFilter)
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, minFilter);
+
+    textureParameters[texture] = TextureParameters { .wrapS = wrapS, .wrapT = wrapT, .magFilter = magFilter, .minFilter = minFilter };
+}
+
+OpenGLState::UniformValue *OpenGLState::getUniform(GLint location) {
+    if (location < 0)
+        return nullptr;
+
+    // without a known program the value can't be shadowed and always goes through
+    if (!programUniforms) {
+        untrackedUniform.valid = false;
+        return &untrackedUniform;
+    }
+
+    if ((size_t) location >= programUniforms->size())
+        programUniforms->resize(location + 1);
+    return &(*programUniforms)[location];
+}
+
+void OpenGLState::uniform1i(GLint location, GLint value) {
+    UniformValue *uniform = getUniform(location);
+    if (!uniform || (uniform->valid && uniform->i == value))
+        return;
+
+    uniform->valid = true;
+    uniform->i = value;
+    glUniform1i(location, value);
+}
+
+void OpenGLState::uniform1f(GLint location, GLfloat value) {
+    UniformValue *uniform = getUniform(location);
+    if (!uniform || (uniform->valid && uniform->f[0] == value))
+        return;
+
+    uniform->valid = true;
+    uniform->f[0] = value;
+    glUniform1f(location, value);
+}
+
+void OpenGLState::uniform4f(GLint location, GLfloat x, GLfloat y, GLfloat z, GLfloat w) {
+    UniformValue *uniform = getUniform(location);
+    if (!uniform || (uniform->valid && uniform->f[0] == x && uniform->f[1] == y && uniform->f[2] == z && uniform->f[3] == w))
+        return;
+
+    uniform->valid = true;
+    uniform->f[0] = x;
+    uniform->f[1] = y;
+    uniform->f[2] = z;
+    uniform->f[3] = w;
+    glUniform4f(location, x, y, z, w);
+}
+}
\ No newline at end of file
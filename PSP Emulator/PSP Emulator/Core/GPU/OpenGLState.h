@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+
+#include <GL/glew.h>
+
+namespace Core::GPU {
+// shadow of the GL state the renderer touches, calls which wouldn't change anything are
+// dropped before they reach the driver. code bypassing it has to call invalidate() after
+class OpenGLState {
+private:
+    enum Capability : int {
+        CAPABILITY_BLEND,
+        CAPABILITY_DEPTH_TEST,
+        CAPABILITY_CULL_FACE,
+        CAPABILITY_COUNT
+    };
+
+    struct UniformValue {
+        bool valid;
+        GLint i;
+        GLfloat f[4];
+    };
+
+    struct TextureParameters {
+        GLint wrapS, wrapT, magFilter, minFilter;
+    };
+
+    int8_t capabilities[CAPABILITY_COUNT]; // -1 when unknown
+    bool blendFuncValid, frontFaceValid, depthRangeValid, programValid, textureValid;
+    GLenum blendSource, blendDestination;
+    GLenum frontFaceMode;
+    GLdouble depthNear, depthFar;
+    GLuint program;
+    GLuint texture;
+    std::unordered_map<GLuint, std::vector<UniformValue>> uniforms; // per program, indexed by location
+    std::vector<UniformValue> *programUniforms; // of the bound program, nullptr when it isn't known
+    UniformValue untrackedUniform;
+    std::unordered_map<GLuint, TextureParameters> textureParameters;
+
+    static int getCapabilityIndex(GLenum capability);
+    UniformValue *getUniform(GLint location);
+public:
+    OpenGLState();
+
+    void invalidate();
+
+    void enable(GLenum capability, bool enabled);
+    void blendFunc(GLenum source, GLenum destination);
+    void frontFace(GLenum mode);
+    void depthRange(GLdouble zNear, GLdouble zFar);
+
+    void useProgram(GLuint program);
+    void deleteProgram(GLuint program);
+
+    void bindTexture(GLuint texture);
+    void deleteTexture(GLuint texture);
+    void textureParameters2D(GLint wrapS, GLint wrapT, GLint magFilter, GLint minFilter); // for the bound texture
+
+    void uniform1i(GLint location, GLint value);
+    void uniform1f(GLint location, GLfloat value);
+    void uniform4f(GLint location, GLfloat x, GLfloat y, GLfloat z, GLfloat w);
+};
+}
\ No newline at end of file
@@ -0,0 +1,144 @@
+#include <Core/GPU/OpenGLStreamBuffer.h>
+
+#include <Core/Logger.h>
+
+namespace Core::GPU {
+static const char *logType = "Renderer";
+
+static inline size_t alignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+OpenGLStreamBuffer::OpenGLStreamBuffer() {
+    handle = 0;
+    bufferSize = segmentSize = position = 0;
+    currentSegment = 0;
+    persistent = false;
+    mapped = nullptr;
+    for (auto& i : fences)
+        i = nullptr;
+}
+
+void OpenGLStreamBuffer::create(size_t size) {
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+    bufferSize = size;
+    segmentSize = size / segmentCount;
+    position = 0;
+    currentSegment = 0;
+    mapped = nullptr;
+
+    glGenBuffers(1, &handle);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, handle);
+
+    persistent = GLEW_ARB_buffer_storage;
+    if (persistent) {
+        glBufferStorage(GL_COPY_WRITE_BUFFER, size, nullptr, flags);
+        mapped = (uint8_t *) glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, size, flags);
+        if (!mapped) {
+            // immutable storage can't be specified again
+            LOG_WARN(logType, "can't map stream buffer persistently, falling back to orphaning");
+            persistent = false;
+            glDeleteBuffers(1, &handle);
+            glGenBuffers(1, &handle);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, handle);
+        }
+    }
+
+    if (!persistent)
+        glBufferData(GL_COPY_WRITE_BUFFER, size, nullptr, GL_STREAM_DRAW);
+}
+
+void OpenGLStreamBuffer::destroy() {
+    if (!handle)
+        return;
+
+    if (mapped) {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, handle);
+        glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+        mapped = nullptr;
+    }
+
+    for (auto& i : fences) {
+        if (i)
+            glDeleteSync(i);
+        i = nullptr;
+    }
+
+    glDeleteBuffers(1, &handle);
+    handle = 0;
+}
+
+void OpenGLStreamBuffer::waitSegment(int segment) {
+    if (!fences[segment])
+        return;
+
+    GLenum result;
+    do {
+        result = glClientWaitSync(fences[segment], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+    } while (result == GL_TIMEOUT_EXPIRED);
+
+    glDeleteSync(fences[segment]);
+    fences[segment] = nullptr;
+}
+
+void OpenGLStreamBuffer::fenceSegment(int segment) {
+    if (fences[segment])
+        glDeleteSync(fences[segment]);
+    fences[segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+bool OpenGLStreamBuffer::reserve(size_t size, size_t alignment) {
+    size_t available = persistent ? segmentSize : bufferSize;
+    if (size + alignment <= available)
+        return false;
+
+    size_t newSize = alignUp((size + alignment) * segmentCount, 0x100000);
+    LOG_WARN(logType, "stream buffer of %zu bytes is too small, growing to %zu bytes", bufferSize, newSize);
+
+    glFinish();
+    destroy();
+    create(newSize);
+    return true;
+}
+
+void *OpenGLStreamBuffer::map(size_t size, size_t alignment, size_t& offset) {
+    if (size == 0)
+        return nullptr;
+
+    reserve(size, alignment);
+
+    offset = alignUp(position, alignment);
+    if (persistent) {
+        // allocations never straddle segments, the fence of a segment is placed once
+        // every draw reading from it has been issued
+        if (offset + size > size_t(currentSegment + 1) * segmentSize) {
+            int next = (currentSegment + 1) % segmentCount;
+            fenceSegment(currentSegment);
+            waitSegment(next);
+            currentSegment = next;
+            offset = alignUp(next * segmentSize, alignment);
+        }
+
+        position = offset + size;
+        return mapped + offset;
+    }
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, handle);
+    if (offset + size > bufferSize) {
+        glBufferData(GL_COPY_WRITE_BUFFER, bufferSize, nullptr, GL_STREAM_DRAW);
+        offset = 0;
+    }
+
+    position = offset + size;
+    return glMapBufferRange(GL_COPY_WRITE_BUFFER, offset, size, GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+}
+
+void OpenGLStreamBuffer::unmap() {
+    if (persistent)
+        return;
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, handle);
+    glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+}
+}
\ No newline at end of file
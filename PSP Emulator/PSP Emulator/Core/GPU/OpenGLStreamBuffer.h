@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <GL/glew.h>
+
+namespace Core::GPU {
+// ring buffer the per draw vertex and index data is streamed through. with ARB_buffer_storage
+// the storage stays mapped and is split in segments guarded by fences, otherwise every
+// allocation is mapped unsynchronized and the storage is orphaned when the ring wraps.
+// the buffer is only ever bound to GL_COPY_WRITE_BUFFER so the VAO bindings aren't touched
+class OpenGLStreamBuffer {
+private:
+    static constexpr int segmentCount = 4;
+
+    GLuint handle;
+    size_t bufferSize;
+    size_t segmentSize;
+    size_t position;
+    int currentSegment;
+    bool persistent;
+    uint8_t *mapped;
+    GLsync fences[segmentCount];
+
+    void waitSegment(int segment);
+    void fenceSegment(int segment);
+public:
+    OpenGLStreamBuffer();
+
+    void create(size_t size);
+    void destroy();
+
+    // recreates a larger buffer when size can't fit in a segment, returns true if it did
+    bool reserve(size_t size, size_t alignment);
+    // the returned pointer is valid until unmap(), offset is aligned to alignment (which doesn't need to be a power of two)
+    void *map(size_t size, size_t alignment, size_t& offset);
+    void unmap();
+
+    GLuint getHandle() const { return handle; }
+    bool isPersistent() const { return persistent; }
+};
+}
\ No newline at end of file
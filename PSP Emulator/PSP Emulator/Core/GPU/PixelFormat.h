@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+
+#include <Core/GPU/GEConstants.h>
+
+namespace Core::GPU {
+// framebuffers always live in VRAM, the pointers only carry the offset into it
+inline uint32_t __getFramebufferAddress(uint32_t address) {
+    return 0x04000000 | (address & 0x1FFFF0);
+}
+
+inline uint32_t __getPixelSize(uint32_t pixelFormat) {
+    return pixelFormat == CMODE_FORMAT_32BIT_ABGR8888 ? 4 : 2;
+}
+
+// ABGR8888 to one of the 16-bit formats
+inline uint16_t __packColor(uint32_t c, uint32_t pixelFormat) {
+    switch (pixelFormat) {
+    case CMODE_FORMAT_16BIT_BGR5650:
+        return uint16_t(((c >> 3) & 0x1F) | ((c >> 5) & 0x7E0) | ((c >> 8) & 0xF800));
+    case CMODE_FORMAT_16BIT_ABGR5551:
+        return uint16_t(((c >> 3) & 0x1F) | ((c >> 6) & 0x3E0) | ((c >> 9) & 0x7C00) | ((c >> 16) & 0x8000));
+    default:
+        return uint16_t(((c >> 4) & 0xF) | ((c >> 8) & 0xF0) | ((c >> 12) & 0xF00) | ((c >> 16) & 0xF000));
+    }
+}
+}
\ No newline at end of file
@@ -6,12 +6,24 @@
 #include <iostream>
 #include <fstream>
 #include <algorithm>
+#include <cstring>
 
 #include <Core/GPU/GPU.h>
 #include <Core/GPU/Renderer.h>
 #include <Core/GPU/GEConstants.h>
 #include <Core/GPU/VertexDecoder.h>
+#include <Core/GPU/Skinning.h>
+#include <Core/GPU/Tessellation.h>
+#include <Core/GPU/Culling.h>
+#include <Core/GPU/ClearMode.h>
+#include <Core/GPU/GPUProfiler.h>
 #include <Core/GPU/TextureDecoder.h>
+#include <Core/GPU/OpenGLState.h>
+#include <Core/GPU/OpenGLStreamBuffer.h>
+#include <Core/GPU/OpenGLShaderCache.h>
+#include <Core/GPU/OpenGLFramebufferManager.h>
+#include <Core/GPU/PixelFormat.h>
+#include <Core/GPU/sceDisplay.h>
 
 #include <Core/Memory/MemoryAccess.h>
 
@@ -156,32 +168,42 @@ done:
     return status;
 }
 
+static constexpr size_t vertexStreamSize = 32 << 20;
+static constexpr size_t indexStreamSize = 4 << 20;
+static constexpr int rectangleIndexVertices = 0x10000; // 16-bit indices, larger rectangle lists are drawn in chunks
+static constexpr int renderScale = 2;
+
 struct RenderDeviceOpenGL : public RenderDevice {
 public:
-    std::vector<VertexData> *_vertexData;
-    std::vector<int> indices;
+    const DecodedVertexList *_vertexData;
     TextureData *_textureData;
-
-    GLuint m_VBO, m_VAO, m_EBO;
+    RenderTarget *_renderTargetTexture; // sampled instead of _textureData when set
+    int _renderTargetOffsetX, _renderTargetOffsetY;
+
+    GLuint m_VAO, m_RectangleEBO;
+    OpenGLStreamBuffer vertexStream, indexStream;
+    GLuint boundElementBuffer; // element buffer binding of m_VAO
+    GLint vertexBase;
+    size_t indexOffset;
+    bool vertexDataUploaded;
     GLuint m_FramebufferVAO, m_FramebufferVBO;
-    GLuint m_FramebufferObject, m_RenderBufferObject, m_FramebufferTexture;
+    OpenGLFramebufferManager framebufferManager;
+    GLuint m_DisplayTexture; // framebuffer the CPU drew into, converted by sceDisplay
+    bool presentDisplayTexture;
 
     GLuint m_StreamingTextureHandle;
     // uint32_t vertexOperationFlags, pixelOperationFlags;
     bool streamingTexture;
-    GLint useTextureIndex;
-    GLint uProjectionIndex, uViewIndex, uWorldIndex, uBoneIndex;
-    GLint uWeightCountIndex;
-    GLint materialAmbientEnableIndex, materialDiffuseEnableIndex, materialSpecularEnableIndex;
-    GLint materialAmbientIndex, materialDiffuseIndex, materialSpecularIndex;
-    GLint textureScaleUIndex, textureScaleVIndex;
-    GLint textureOffsetUIndex, textureOffsetVIndex;
-    GLint skinningEnable;
-    uint32_t throughModeVertexProcessor, normalModeVertexProcessor;
-    uint32_t throughModeFragmentProcessor, normalModeFragmentProcessor;
-    uint32_t m_Program, m_FramebufferProgram;
+    OpenGLShaderCache shaderCache;
+    ShaderProgram *currentProgram;
+    uint64_t matrixGeneration; // bumped whenever the GE matrices change, programs upload them lazily
+    uint32_t m_FramebufferProgram;
     bool validOpenGLState;
     bool __prepareDraw;
+    OpenGLState glState;
+private:
+    void bindVertexAttributes();
+    void bindElementBuffer(GLuint buffer);
 public:
     RenderDeviceOpenGL();
     ~RenderDeviceOpenGL();
@@ -190,6 +212,7 @@ public:
     void prepareDraw(GPUState *state, int type, int count) override;
     void drawPrimitive(GPUState *state, int type, int count) override;
     void endDraw(GPUState *state) override;
+    void clear(GPUState *state, const ClearRectangle& clear); // clear mode rectangles without a draw
 
     const char *getDeviceName() override { return "OpenGL"; }
     virtual RendererType getDeviceType() override { return RENDERER_TYPE_OPENGL; }
@@ -199,104 +222,77 @@ void __openglDebugCallback(GLenum source, GLenum type, GLuint id, GLenum severit
     LOG_ERROR(logType, "an error has occurred with OpenGL: %d %s", source, message);
 }
 
+// DXT levels are already reordered to S3TC blocks, GL can't generate mipmaps for them
+static void __uploadCompressedTexture(const TextureData *data, int level) {
+    glCompressedTexImage2D(GL_TEXTURE_2D, level, data->compressedFormat, data->textureInfo.textureWidth[level],
+        data->textureInfo.textureHeight[level], 0, data->compressedLevelSize[level], data->decodedLevel[level]);
+}
+
 RenderDeviceOpenGL::RenderDeviceOpenGL() {
     _vertexData = nullptr;
     _textureData = nullptr;
+    _renderTargetTexture = nullptr;
+    _renderTargetOffsetX = _renderTargetOffsetY = 0;
 
-    m_Program = 0;
     m_FramebufferProgram = 0;
-    m_VBO = 0;
     m_VAO = 0;
-    m_EBO = 0;
+    m_RectangleEBO = 0;
+    boundElementBuffer = 0;
+    vertexBase = 0;
+    indexOffset = 0;
+    vertexDataUploaded = false;
     m_FramebufferVAO = 0;
     m_FramebufferVBO = 0;
-    m_FramebufferObject = 0;
-    m_RenderBufferObject = 0;
-    m_FramebufferTexture = 0;
-    throughModeVertexProcessor = 0;
-    normalModeVertexProcessor = 0;
-    throughModeFragmentProcessor = 0;
-    normalModeFragmentProcessor = 0;
+    m_DisplayTexture = 0;
+    presentDisplayTexture = false;
     streamingTexture = false;
     m_StreamingTextureHandle = 0;
     __prepareDraw = false;
 
-    useTextureIndex = 0;
-    uProjectionIndex = uViewIndex = uWorldIndex = uBoneIndex = uWeightCountIndex = 0;
-    materialAmbientEnableIndex = materialDiffuseEnableIndex = materialSpecularEnableIndex = 0;
-    materialAmbientIndex = materialDiffuseIndex = materialSpecularIndex = 0;
-    textureScaleUIndex = 0;
-    textureScaleVIndex = 0;
-    textureOffsetUIndex = 0;
-    textureOffsetVIndex = 0;
-    skinningEnable = 0;
+    currentProgram = nullptr;
+    matrixGeneration = 1;
 
     if (glGetString(GL_VENDOR) == nullptr) {
         validOpenGLState = false;
         return;
     }
     validOpenGLState = true;
-    if (createShader(m_Program, "Shaders/NTMVertexShader.glsl", "Shaders/NTMFragmentShader.glsl") != false)
-        LOG_SUCCESS(logType, "successfully created normal/through mode shader");
+    if (shaderCache.create(&glState, "Shaders/NTMVertexShader.glsl", "Shaders/NTMFragmentShader.glsl", "ShaderCache") != false)
+        LOG_SUCCESS(logType, "successfully loaded normal/through mode shader sources");
     else
-        LOG_ERROR(logType, "an error has occured while processing normal/through mode shader");
+        LOG_ERROR(logType, "an error has occured while loading normal/through mode shader sources");
 
     if (createShader(m_FramebufferProgram, "Shaders/FramebufferVertexShader.glsl", "Shaders/FramebufferFragmentShader.glsl") != false)
         LOG_SUCCESS(logType, "successfully created framebuffer shader");
     else
         LOG_ERROR(logType, "an error has occured while processing framebuffer shader");
 
-    throughModeVertexProcessor = glGetSubroutineIndex(m_Program, GL_VERTEX_SHADER, "throughModeVertexProcessor");
-    throughModeFragmentProcessor = glGetSubroutineIndex(m_Program, GL_FRAGMENT_SHADER, "throughModeFragmentProcessor");
-
-    normalModeVertexProcessor = glGetSubroutineIndex(m_Program, GL_VERTEX_SHADER, "normalModeVertexProcessor");
-    normalModeFragmentProcessor = glGetSubroutineIndex(m_Program, GL_FRAGMENT_SHADER, "normalModeFragmentProcessor");
-
-    useTextureIndex = glGetUniformLocation(m_Program, "_useTexture");
-    uProjectionIndex = glGetUniformLocation(m_Program, "uProjection");
-    uViewIndex = glGetUniformLocation(m_Program, "uView");
-    uWorldIndex = glGetUniformLocation(m_Program, "uWorld");
-    uBoneIndex = glGetUniformLocation(m_Program, "uBone");
-    uWeightCountIndex = glGetUniformLocation(m_Program, "uWeightCount");
-    materialAmbientEnableIndex = glGetUniformLocation(m_Program, "materialAmbientEnable");
-    materialDiffuseEnableIndex = glGetUniformLocation(m_Program, "materialDiffuseEnable");
-    materialSpecularEnableIndex = glGetUniformLocation(m_Program, "materialSpecularEnable");
-    materialAmbientIndex = glGetUniformLocation(m_Program, "materialAmbient");
-    materialDiffuseIndex = glGetUniformLocation(m_Program, "materialDiffuse");
-    materialSpecularIndex = glGetUniformLocation(m_Program, "materialSpecular");
-    textureScaleUIndex = glGetUniformLocation(m_Program, "textureScaleU");
-    textureScaleVIndex = glGetUniformLocation(m_Program, "textureScaleV");
-    textureOffsetUIndex = glGetUniformLocation(m_Program, "textureOffsetU");
-    textureOffsetVIndex = glGetUniformLocation(m_Program, "textureOffsetV");
-    skinningEnable = glGetUniformLocation(m_Program, "skinningEnable");
-
-    LOG_DEBUG(logType, "(vertex, fragment) Through Mode subroutine %d %d index Normal Mode subroutine index %d %d",
-                throughModeVertexProcessor, throughModeFragmentProcessor, normalModeVertexProcessor, normalModeFragmentProcessor);
-
     glGenTextures(1, &m_StreamingTextureHandle);
+    setCompressedTextureSupport(GLEW_EXT_texture_compression_s3tc);
 
     glGenVertexArrays(1, &m_VAO);
-    glGenBuffers(1, &m_VBO);
-    glGenBuffers(1, &m_EBO);
+    glGenBuffers(1, &m_RectangleEBO);
+    vertexStream.create(vertexStreamSize);
+    indexStream.create(indexStreamSize);
+    LOG_DEBUG(logType, "streaming vertices through %s buffers", vertexStream.isPersistent() ? "persistently mapped" : "orphaned");
 
     glBindVertexArray(m_VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
-
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(VertexData), (const void *)offsetof(VertexData, position));
+    bindVertexAttributes();
+
+    // rectangles are expanded to 4 vertices each so they all share one index pattern
+    std::vector<uint16_t> rectangleIndices;
+    for (int i = 0; i < rectangleIndexVertices; i += 4) {
+        rectangleIndices.push_back(i + 0);
+        rectangleIndices.push_back(i + 1);
+        rectangleIndices.push_back(i + 2);
+        rectangleIndices.push_back(i + 2);
+        rectangleIndices.push_back(i + 1);
+        rectangleIndices.push_back(i + 3);
+    }
 
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(VertexData), (const void *)offsetof(VertexData, uv));
-    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(VertexData), (const void *)offsetof(VertexData, color));
-    glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(VertexData), (const void *)offsetof(VertexData, normal));
-    glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, sizeof(VertexData), (const void *)offsetof(VertexData, w));
-    glVertexAttribPointer(5, 4, GL_FLOAT, GL_FALSE, sizeof(VertexData), (const void *)(offsetof(VertexData, w) + 4 * sizeof(float)));
-    glEnableVertexAttribArray(0);
-    glEnableVertexAttribArray(1);
-    glEnableVertexAttribArray(2);
-    glEnableVertexAttribArray(3);
-    glEnableVertexAttribArray(4);
-    glEnableVertexAttribArray(5);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RectangleEBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, rectangleIndices.size() * sizeof(uint16_t), rectangleIndices.data(), GL_STATIC_DRAW);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
 
     glGenVertexArrays(1, &m_FramebufferVAO);
@@ -328,27 +324,16 @@ RenderDeviceOpenGL::RenderDeviceOpenGL() {
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
 
-    glGenFramebuffers(1, &m_FramebufferObject);
-    glBindFramebuffer(GL_FRAMEBUFFER, m_FramebufferObject);
-    glGenTextures(1, &m_FramebufferTexture);
-    glBindTexture(GL_TEXTURE_2D, m_FramebufferTexture);
+    framebufferManager.create(&glState, renderScale);
 
     static std::vector<uint8_t> data;
-    data.resize((480 * 3) * (272 * 3) * 4, 0x00);
+    data.resize(480 * 272 * 4, 0x00);
 
+    glGenTextures(1, &m_DisplayTexture);
+    glBindTexture(GL_TEXTURE_2D, m_DisplayTexture);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 480*2, 272*2, 0, GL_RGBA, GL_UNSIGNED_BYTE, &data[0]);
-
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_FramebufferTexture, 0);
-
-    glGenRenderbuffers(1, &m_RenderBufferObject);
-    glBindRenderbuffer(GL_RENDERBUFFER, m_RenderBufferObject);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, 480*2, 272*2);
-    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_RenderBufferObject);
-
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 480, 272, 0, GL_RGBA, GL_UNSIGNED_BYTE, &data[0]);
     glBindTexture(GL_TEXTURE_2D, 0);
 
 #if 0
@@ -367,34 +352,60 @@ RenderDeviceOpenGL::~RenderDeviceOpenGL() {
             glDeleteTextures(1, (GLuint *)&i->handle);
     }
 
-    glDeleteProgram(m_Program);
+    shaderCache.destroy();
     glDeleteProgram(m_FramebufferProgram);
 
     glDeleteVertexArrays(1, &m_VAO);
-    glDeleteBuffers(1, &m_VBO);
+    glDeleteBuffers(1, &m_RectangleEBO);
+    vertexStream.destroy();
+    indexStream.destroy();
 
     glDeleteVertexArrays(1, &m_FramebufferVAO);
     glDeleteBuffers(1, &m_FramebufferVBO);
-    glDeleteRenderbuffers(1, &m_RenderBufferObject);
-    glDeleteFramebuffers(1, &m_FramebufferObject);
-    glDeleteTextures(1, &m_FramebufferTexture);
+    framebufferManager.destroy();
+    glDeleteTextures(1, &m_DisplayTexture);
 }
 
 void RenderDeviceOpenGL::displayListBegin() {
-    glBindFramebuffer(GL_FRAMEBUFFER, m_FramebufferObject);
-    glUseProgram(m_Program);
+    // the screen is presented with plain GL calls in between lists
+    glState.invalidate();
+    framebufferManager.invalidateBinding();
     glBindVertexArray(m_VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
 }
 
 void RenderDeviceOpenGL::displayListEnd() {
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    bindElementBuffer(0);
     glBindVertexArray(0);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    glState.bindTexture(0);
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
-    glUseProgram(0);
+    glState.useProgram(0);
+}
+
+// the vertex stream can be recreated when a draw outgrows it, the attributes follow it
+void RenderDeviceOpenGL::bindVertexAttributes() {
+    glBindBuffer(GL_ARRAY_BUFFER, vertexStream.getHandle());
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(VertexData), (const void *)offsetof(VertexData, position));
+
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(VertexData), (const void *)offsetof(VertexData, uv));
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(VertexData), (const void *)offsetof(VertexData, color));
+    glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(VertexData), (const void *)offsetof(VertexData, normal));
+    glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, sizeof(VertexData), (const void *)offsetof(VertexData, w));
+    glVertexAttribPointer(5, 4, GL_FLOAT, GL_FALSE, sizeof(VertexData), (const void *)(offsetof(VertexData, w) + 4 * sizeof(float)));
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+    glEnableVertexAttribArray(2);
+    glEnableVertexAttribArray(3);
+    glEnableVertexAttribArray(4);
+    glEnableVertexAttribArray(5);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void RenderDeviceOpenGL::bindElementBuffer(GLuint buffer) {
+    if (boundElementBuffer == buffer)
+        return;
+
+    boundElementBuffer = buffer;
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer);
 }
 
 // v and vecOut must point to different memory.
@@ -404,39 +415,6 @@ inline void Vec3ByMatrix43(float vecOut[3], const float v[3], const float m[12])
     vecOut[2] = v[0] * m[2] + v[1] * m[5] + v[2] * m[8] + m[11];
 }
 
-static void __calculateSkinningPosition(GPUState *state, glm::vec3& _pos, float *w) {
-    float x = 0.f, y = 0.f, z = 0.f;
-    int wc = ((state->vertexInfo.param >> 14) & 7) + 1;
-
-    GE_Matrix4x4 skinMatrix[8];
-    for (int i = 0; i < wc; i++)
-    {
-        float weight = w[i];
-        if (weight != 0.f) {
-            GE_Matrix4x4& matrix = state->boneMatrix[i];
-
-            x += (	_pos.x * matrix.mData[0]
-                + 	_pos.y * matrix.mData[4]
-                + 	_pos.z * matrix.mData[8]
-                +           matrix.mData[12]) * weight;
-
-            y += (	_pos.x * matrix.mData[1]
-                + 	_pos.y * matrix.mData[5]
-                + 	_pos.z * matrix.mData[9]
-                +           matrix.mData[13]) * weight;
-
-            z += (	_pos.x * matrix.mData[2]
-                + 	_pos.y * matrix.mData[6]
-                + 	_pos.z * matrix.mData[10]
-                +           matrix.mData[14]) * weight;
-        }
-    }
-
-    _pos.x = x;
-    _pos.y = y;
-    _pos.z = z;
-}
-
 void RenderDeviceOpenGL::prepareDraw(GPUState *state, int type, int count) {
     if (!validOpenGLState)
         return;
@@ -452,22 +430,18 @@ void RenderDeviceOpenGL::prepareDraw(GPUState *state, int type, int count) {
 
     throughMode = state->vertexInfo.tm != 0;
 
-    uint32_t currentVertexShaderSubroutine;
-    uint32_t currentFragmentShaderSubroutine;
+    framebufferManager.bind(state->framebufferInfo);
 
-    if (throughMode) {
-        currentVertexShaderSubroutine = throughModeVertexProcessor;
-        currentFragmentShaderSubroutine = throughModeFragmentProcessor;
-    } else {
-        currentVertexShaderSubroutine = normalModeVertexProcessor;
-        currentFragmentShaderSubroutine = normalModeFragmentProcessor;
+    currentProgram = shaderCache.getProgram(__getShaderID(state, _textureData != nullptr || _renderTargetTexture != nullptr));
+    if (!currentProgram) {
+        __prepareDraw = false;
+        return;
     }
 
-    glUniformSubroutinesuiv(GL_VERTEX_SHADER, 1, &currentVertexShaderSubroutine);
-    glUniformSubroutinesuiv(GL_FRAGMENT_SHADER, 1, &currentFragmentShaderSubroutine);
+    glState.useProgram(currentProgram->program);
 
     if (_vertexData) {
-        auto& vertexData = *_vertexData;
+        auto& vertexData = _vertexData->vertices;
 
         static VertexData vertices[] = {
             // bottom right
@@ -481,96 +455,117 @@ void RenderDeviceOpenGL::prepareDraw(GPUState *state, int type, int count) {
         };
 
         if (throughMode) {
-            if (type == GE_PRIM_RECTANGLES) {
-                indices.clear();
-
-                for (int i = 0; i < vertexData.size(); i += 4) {
-                    indices.push_back(i + 0);
-                    indices.push_back(i + 1);
-                    indices.push_back(i + 2);
-                    indices.push_back(i + 2);
-                    indices.push_back(i + 1);
-                    indices.push_back(i + 3);
-                }
+            glState.uniform1f(currentProgram->textureScaleXIndex, (float) state->textureInfo.textureWidth[0]);
+            glState.uniform1f(currentProgram->textureScaleYIndex, (float) state->textureInfo.textureHeight[0]);
+        }
 
-                glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint32_t), &indices[0], GL_STATIC_DRAW);
-            }
+        size_t vertexSize = vertexData.size() * sizeof(VertexData);
+        size_t vertexOffset;
 
-            glUniform1i(glGetUniformLocation(m_Program, "throughMode"), 1);
-            glUniform1f(glGetUniformLocation(m_Program, "textureScaleX"), (float) state->textureInfo.textureWidth[0]);
-            glUniform1f(glGetUniformLocation(m_Program, "textureScaleY"), (float) state->textureInfo.textureHeight[0]);
-        } else {
-            glUniform1i(glGetUniformLocation(m_Program, "throughMode"), 0);
-        }
+        if (vertexStream.reserve(vertexSize, sizeof(VertexData)))
+            bindVertexAttributes();
 
-        if ((state->vertexInfo.param & GE_VTYPE_WEIGHT_MASK) != 0) {
-            for (int i = 0; i < count; i++)
-                __calculateSkinningPosition(state, vertexData[i].position, vertexData[i].w);
+        vertexDataUploaded = false;
+        if (void *out = vertexStream.map(vertexSize, sizeof(VertexData), vertexOffset)) {
+            std::memcpy(out, vertexData.data(), vertexSize);
+            vertexStream.unmap();
+            vertexBase = GLint(vertexOffset / sizeof(VertexData));
+            vertexDataUploaded = true;
         }
 
-        glBufferData(GL_ARRAY_BUFFER, vertexData.size() * sizeof(VertexData), &vertexData[0], GL_STATIC_DRAW);
+        if (_vertexData->indexType != 0 && vertexDataUploaded) {
+            size_t indexSize = _vertexData->indices.size();
+            if (indexStream.reserve(indexSize, sizeof(uint32_t)))
+                boundElementBuffer = 0; // the old name is gone from the VAO
 
-        // glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), &vertices[0], GL_STATIC_DRAW);
+            bindElementBuffer(indexStream.getHandle());
+            if (void *out = indexStream.map(indexSize, sizeof(uint32_t), indexOffset)) {
+                std::memcpy(out, _vertexData->indices.data(), indexSize);
+                indexStream.unmap();
+            } else {
+                vertexDataUploaded = false;
+            }
+        }
 
         if (state->matrixUpdated) {
-            glUniformMatrix4fv(uProjectionIndex, 1, GL_FALSE, &state->projectionMatrix.mData[0]);
-            glUniformMatrix4fv(uViewIndex, 1, GL_FALSE, &state->viewMatrix.mData[0]);
-            glUniformMatrix4fv(uWorldIndex, 1, GL_FALSE, &state->worldMatrix.mData[0]);
-            glUniformMatrix4fv(uBoneIndex, 1, GL_FALSE, &state->boneMatrix->mData[0]);
+            matrixGeneration++;
             state->matrixUpdated = false;
         }
+
+        if (currentProgram->matrixGeneration != matrixGeneration) {
+            glUniformMatrix4fv(currentProgram->uProjectionIndex, 1, GL_FALSE, &state->projectionMatrix.mData[0]);
+            glUniformMatrix4fv(currentProgram->uViewIndex, 1, GL_FALSE, &state->viewMatrix.mData[0]);
+            glUniformMatrix4fv(currentProgram->uWorldIndex, 1, GL_FALSE, &state->worldMatrix.mData[0]);
+            glUniformMatrix4fv(currentProgram->uBoneIndex, 1, GL_FALSE, &state->boneMatrix->mData[0]);
+            currentProgram->matrixGeneration = matrixGeneration;
+        }
     }
 
-    if (_textureData) {
+    if (_renderTargetTexture) {
+        glState.bindTexture(_renderTargetTexture->colorTexture);
+        glState.textureParameters2D(GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE, state->textureMagFilter ? GL_LINEAR : GL_NEAREST, (state->textureMinFilter & 1) ? GL_LINEAR : GL_NEAREST);
+
+        // targets are stored bottom-up at the display size, the texture is a window into one
+        const GPUState::TextureInfo& info = state->textureInfo;
+        float width = (float) OpenGLFramebufferManager::targetWidth, height = (float) OpenGLFramebufferManager::targetHeight;
+        glState.uniform4f(currentProgram->textureTransformIndex, info.textureWidth[0] / width, -(info.textureHeight[0] / height),
+            _renderTargetOffsetX / width, 1.f - _renderTargetOffsetY / height);
+    } else if (_textureData) {
+        glState.uniform4f(currentProgram->textureTransformIndex, 1.f, 1.f, 0.f, 0.f);
+
         static uint32_t minFilter[] = { GL_NEAREST, GL_LINEAR, 0, 0, GL_NEAREST_MIPMAP_NEAREST, GL_LINEAR_MIPMAP_NEAREST, GL_NEAREST_MIPMAP_LINEAR, GL_LINEAR_MIPMAP_LINEAR };
         auto applyTextureFilters = [&]() {
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, state->textureWrapModeS ? GL_CLAMP_TO_EDGE : GL_REPEAT);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, state->textureWrapModeT ? GL_CLAMP_TO_EDGE : GL_REPEAT);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, state->textureMagFilter ? GL_LINEAR : GL_NEAREST);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, minFilter[state->textureMinFilter]);
+            glState.textureParameters2D(state->textureWrapModeS ? GL_CLAMP_TO_EDGE : GL_REPEAT, state->textureWrapModeT ? GL_CLAMP_TO_EDGE : GL_REPEAT,
+                state->textureMagFilter ? GL_LINEAR : GL_NEAREST, minFilter[state->textureMinFilter]);
             // TODO
         };
 
         auto textureHandler = [&]() {
             if (_textureData->forceUpdate) {
-                glDeleteTextures(1, (GLuint *)&_textureData->handle);        
+                glState.deleteTexture((GLuint) _textureData->handle);
                 _textureData->handle = 0;
                 _textureData->forceUpdate = false;
             }
 
             if (!_textureData->handle) { // create a new texture
                 glGenTextures(1, (GLuint *)&_textureData->handle);
-                glBindTexture(GL_TEXTURE_2D, (GLuint) _textureData->handle);
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+                glState.bindTexture((GLuint) _textureData->handle);
 
                 glPixelStorei(GL_UNPACK_ALIGNMENT, _textureData->textureByteAlignment);
 
                 for (int i = 0; i < _textureData->textureInfo.textureNumMipMaps; i++) {
+                    if (_textureData->compressedFormat) {
+                        __uploadCompressedTexture(_textureData, i);
+                        continue;
+                    }
+
                     glPixelStorei(GL_UNPACK_ROW_LENGTH, _textureData->textureInfo.textureBufferWidth[i]);
 
                     glTexImage2D(GL_TEXTURE_2D, i, GL_RGBA, _textureData->textureInfo.textureWidth[i],
-                        _textureData->textureInfo.textureHeight[i], 0, GL_RGBA, _textureData->getTexturePixelType(), getCurrentDecodedTexture(i));
+                        _textureData->textureInfo.textureHeight[i], 0, GL_RGBA, _textureData->getTexturePixelType(), _textureData->decodedLevel[i]);
                     glGenerateMipmap(GL_TEXTURE_2D);
                 }
 
                 glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
                 glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
             } else {
-                glBindTexture(GL_TEXTURE_2D, (GLuint) _textureData->handle);
+                glState.bindTexture((GLuint) _textureData->handle);
             }
         };
 
         auto streamingTextureHandler = [&]() {
-            glBindTexture(GL_TEXTURE_2D, m_StreamingTextureHandle);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+            glState.bindTexture(m_StreamingTextureHandle);
 
             glPixelStorei(GL_UNPACK_ALIGNMENT, _textureData->textureByteAlignment);
             for (int i = 0; i < _textureData->textureInfo.textureNumMipMaps; i++) {
+                if (_textureData->compressedFormat) {
+                    __uploadCompressedTexture(_textureData, i);
+                    continue;
+                }
+
                 glPixelStorei(GL_UNPACK_ROW_LENGTH, _textureData->textureInfo.textureBufferWidth[i]);
                 glTexImage2D(GL_TEXTURE_2D, i, GL_RGBA, _textureData->textureInfo.textureBufferWidth[i],
-                    _textureData->textureInfo.textureHeight[i], 0, GL_RGBA, _textureData->getTexturePixelType(), getCurrentDecodedTexture(i));
+                    _textureData->textureInfo.textureHeight[i], 0, GL_RGBA, _textureData->getTexturePixelType(), _textureData->decodedLevel[i]);
                 glGenerateMipmap(GL_TEXTURE_2D);
             }
 
@@ -589,84 +584,59 @@ void RenderDeviceOpenGL::prepareDraw(GPUState *state, int type, int count) {
         if (_textureData->key <= 0x10000000) {
             __prepareDraw = false;
         }
-
-        glUniform1f(textureScaleUIndex, state->textureScaleU);
-        glUniform1f(textureScaleVIndex, state->textureScaleV);
-        glUniform1f(textureOffsetUIndex, state->textureOffsetX);
-        glUniform1f(textureOffsetVIndex, state->textureOffsetY);
     } else {
-        glBindTexture(GL_TEXTURE_2D, 0);
-    }
-
-    glUniform1i(glGetUniformLocation(m_Program, "hasVertexColor"), state->vertexInfo.ct != 0);
-
-    bool hasTexture = _textureData != nullptr;
-    glUniform1i(useTextureIndex, hasTexture);
-    glUniform1i(materialAmbientEnableIndex, state->materialAmbientEnable);
-    glUniform1i(materialDiffuseEnableIndex, state->materialDiffuseEnable);
-    glUniform1i(materialSpecularEnableIndex, state->materialSpecularEnable);
-    if (state->materialAmbientEnable) {
-        glUniform4f(materialAmbientIndex, state->materialAmbient[0], state->materialAmbient[1], state->materialAmbient[2], state->materialAmbient[3]);
+        glState.bindTexture(0);
     }
 
-    if (state->materialDiffuseEnable) {
-        glUniform4f(materialDiffuseIndex, state->materialDiffuse[0], state->materialDiffuse[1], state->materialDiffuse[2], state->materialDiffuse[3]);
-    }
-
-    if (state->materialSpecularEnable) {
-        glUniform4f(materialSpecularIndex, state->materialSpecular[0], state->materialSpecular[1], state->materialSpecular[2], state->materialSpecular[3]);
+    // variants without vertex colors take the material ambient color instead
+    if (!(currentProgram->id & SHADER_VERTEX_COLOR)) {
+        glState.uniform4f(currentProgram->materialAmbientIndex, state->materialAmbient[0], state->materialAmbient[1], state->materialAmbient[2], state->materialAmbient[3]);
     }
 
     auto applyAlphaBlending = [&]() {
         bool alphaBlendingEnabled = state->clearModeEnable || state->alphaBlendingEnable;
         if (alphaBlendingEnabled) {
-            glEnable(GL_BLEND);
-            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            glState.enable(GL_BLEND, true);
+            glState.blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
         } else {
-            glDisable(GL_BLEND);
+            glState.enable(GL_BLEND, false);
         }
     };
 
     auto applyDepthTest = [&]() {
         bool depthTestEnabled = state->clearModeEnable || state->depthTestEnable;
-        if (depthTestEnabled) {
-            glEnable(GL_DEPTH_TEST);
-        } else {
-            glDisable(GL_DEPTH_TEST);
-        }
+        glState.enable(GL_DEPTH_TEST, depthTestEnabled);
     };
 
     auto applyAlphaTest = [&]() {
         bool alphaTestEnabled = state->clearModeEnable || state->alphaTestEnable;
 
         if (alphaTestEnabled) {
-            glEnable(GL_BLEND);
-            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            glState.enable(GL_BLEND, true);
+            glState.blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
         } else {
-            glDisable(GL_BLEND);
+            glState.enable(GL_BLEND, false);
         }
     };
 
     auto applyClearMode = [&]() {
-        glUniform1i(glGetUniformLocation(m_Program, "clearModeEnable"), state->clearModeEnable);
-
         if (state->clearModeEnable) {
-            glEnable(GL_DEPTH_TEST);
+            glState.enable(GL_DEPTH_TEST, true);
             glClear(GL_DEPTH_BUFFER_BIT);
-            glDisable(GL_DEPTH_TEST);
+            glState.enable(GL_DEPTH_TEST, false);
         }
     };
 
     auto applyFaceCulling = [&]() {
         if (state->clearModeEnable || type == GE_PRIM_RECTANGLES || !state->cullingEnable) {
-            glDisable(GL_CULL_FACE);
+            glState.enable(GL_CULL_FACE, false);
         } else {
-            glEnable(GL_CULL_FACE);
-            glFrontFace(state->cullingFaceDirection != 0 ? GL_CW : GL_CCW);
+            glState.enable(GL_CULL_FACE, true);
+            glState.frontFace(state->cullingFaceDirection != 0 ? GL_CW : GL_CCW);
         }
     };
 
-    glDepthRange(state->minZ, state->maxZ);
+    glState.depthRange(state->minZ, state->maxZ);
 
     applyDepthTest();
     applyAlphaBlending();
@@ -679,24 +649,46 @@ void RenderDeviceOpenGL::drawPrimitive(GPUState *state, int type, int count) {
     if (!validOpenGLState)
         return;
 
-    if (!__prepareDraw || !_vertexData)
+    if (!__prepareDraw || !_vertexData || !vertexDataUploaded)
         return;
 
+    auto draw = [&](GLenum mode) {
+        if (_vertexData->indexType != 0) {
+            GLenum indexType = _vertexData->indexType == 1 ? GL_UNSIGNED_BYTE : GL_UNSIGNED_SHORT;
+            bindElementBuffer(indexStream.getHandle());
+            glDrawElementsBaseVertex(mode, (GLsizei)_vertexData->indexCount, indexType, (const void *)indexOffset, vertexBase);
+        } else {
+            glDrawArrays(mode, vertexBase, (GLsizei)_vertexData->vertices.size());
+        }
+    };
+
+    auto drawRectangles = [&]() {
+        size_t vertexCount = _vertexData->vertices.size();
+        bindElementBuffer(m_RectangleEBO);
+        for (size_t first = 0; first < vertexCount; first += rectangleIndexVertices) {
+            size_t rectangleVertices = std::min<size_t>(vertexCount - first, rectangleIndexVertices);
+            glDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)(rectangleVertices / 4 * 6), GL_UNSIGNED_SHORT, nullptr, vertexBase + (GLint)first);
+        }
+    };
+
     switch (type) {
     case GE_PRIM_POINTS:
-        glDrawArrays(GL_POINTS, 0, (GLsizei)_vertexData->size());
+        draw(GL_POINTS);
+        break;
+    case GE_PRIM_LINES:
+        draw(GL_LINES);
         break;
     case GE_PRIM_TRIANGLES:
-        glDrawArrays(GL_TRIANGLES, 0, (GLsizei)_vertexData->size());
+        draw(GL_TRIANGLES);
         break;
     case GE_PRIM_TRIANGLE_FAN:
-        glDrawArrays(GL_TRIANGLE_FAN, 0, (GLsizei)_vertexData->size());
+        draw(GL_TRIANGLE_FAN);
         break;
     case GE_PRIM_TRIANGLE_STRIP:
-        glDrawArrays(GL_TRIANGLE_STRIP, 0, (GLsizei)_vertexData->size());
+        draw(GL_TRIANGLE_STRIP);
         break;
     case GE_PRIM_RECTANGLES:
-        glDrawElements(GL_TRIANGLES, (GLsizei)indices.size(), GL_UNSIGNED_INT, 0);
+        drawRectangles();
         break;
     default:
         LOG_ERROR(logType, "Unimplemented draw primitive %d count %d", type, count);
@@ -710,6 +702,48 @@ void RenderDeviceOpenGL::endDraw(GPUState *state) {
     __prepareDraw = false;
 }
 
+void RenderDeviceOpenGL::clear(GPUState *state, const ClearRectangle& clear) {
+    if (!validOpenGLState)
+        return;
+
+    const int width = OpenGLFramebufferManager::targetWidth, height = OpenGLFramebufferManager::targetHeight;
+    int x0 = std::max(clear.x0, 0), y0 = std::max(clear.y0, 0);
+    int x1 = std::min(clear.x1, width), y1 = std::min(clear.y1, height);
+
+    GLbitfield buffers = 0;
+    if (clear.writeColor || clear.writeAlpha)
+        buffers |= GL_COLOR_BUFFER_BIT;
+    if (clear.writeAlpha)
+        buffers |= GL_STENCIL_BUFFER_BIT;
+    if (clear.writeDepth)
+        buffers |= GL_DEPTH_BUFFER_BIT;
+    if (buffers == 0 || x1 <= x0 || y1 <= y0)
+        return;
+
+    framebufferManager.bind(state->framebufferInfo);
+
+    // the stencil takes the alpha value. depth functions aren't translated yet and everything
+    // is tested with GL_LESS, so depth is cleared to the far plane like the drawn rectangle did
+    glColorMask(clear.writeColor, clear.writeColor, clear.writeColor, clear.writeAlpha);
+    glClearColor(clear.color[0], clear.color[1], clear.color[2], clear.color[3]);
+    glClearStencil(int(std::clamp(clear.color[3], 0.f, 1.f) * 255.f + .5f));
+    glClearDepth(1.0);
+
+    // targets are stored bottom-up at the render scale
+    bool scissored = x0 > 0 || y0 > 0 || x1 < width || y1 < height;
+    if (scissored) {
+        int scale = framebufferManager.getRenderScale();
+        glEnable(GL_SCISSOR_TEST);
+        glScissor(x0 * scale, (height - y1) * scale, (x1 - x0) * scale, (y1 - y0) * scale);
+    }
+
+    glClear(buffers);
+
+    if (scissored)
+        glDisable(GL_SCISSOR_TEST);
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+}
+
 void __RenderDeviceDisplayListBegin() {
     RenderDevice *dev = getRenderDevice();
     if (!dev)
@@ -730,62 +764,233 @@ void __DrawDebugPrimitive(GPUState *state, int type, int count) {
 
 }
 
-void __PrepareDraw(GPUState *state, int type, int count) {
+void __RenderDeviceEndFrame() {
     RenderDevice *dev = getRenderDevice();
-    if (!dev)
+    __FlushPrimitives(getGPUState()); // textures are evicted below
+    auto _handle = __updateTextureCache(dev && dev->getDeviceType() == RENDERER_TYPE_OPENGL);
+
+    if (!dev || dev->getDeviceType() != RENDERER_TYPE_OPENGL)
         return;
 
+    for (auto& i : _handle) {
+        if (i.handle)
+            reinterpret_cast<RenderDeviceOpenGL *>(dev)->glState.deleteTexture((GLuint) i.handle);
+        // LOG_DEBUG(logType, "deleted key 0x%016llx.texcache (evicted)", i.key);
+    }
+
+    reinterpret_cast<RenderDeviceOpenGL *>(dev)->framebufferManager.endFrame();
+}
+
+// consecutive primitives sharing every piece of render state are merged into one draw,
+// the display list flushes the batch before a command changes that state
+struct PrimitiveBatch {
+    DecodedVertexList list;
+    TextureData *textureData;
+    int type;
+    int count;
+    int draws;
+};
+
+static PrimitiveBatch primitiveBatch;
+static constexpr size_t maxBatchVertices = 0x10000; // batched indices are 16-bit
+
+static bool __isBatchablePrimitive(int type) {
+    switch (type) {
+    case GE_PRIM_POINTS:
+    case GE_PRIM_LINES:
+    case GE_PRIM_TRIANGLES:
+    case GE_PRIM_RECTANGLES:
+        return true;
+    }
+    return false;
+}
+
+static void __drawVertexList(RenderDevice *dev, GPUState *state, int type, int count, const DecodedVertexList *vertexData, TextureData *textureData) {
+    ProfilerScope scope(PROFILER_STAGE_SUBMIT);
 
-    std::vector<VertexData> *vertexData = __getListFromVertexCache(state, type, count);
-    TextureData *textureData, streamingTexture;
-    
     switch (dev->getDeviceType()) {
     case RENDERER_TYPE_OPENGL:
     {
         auto oglDevice = reinterpret_cast<RenderDeviceOpenGL *>(dev);
-    
-        auto _handle = __updateTextureCache();
-        if (_handle.size() != 0) {
-            for (auto& i : _handle) {            
-                if (i.handle)
-                    glDeleteTextures(1, (GLuint *)&i.handle);
-                // LOG_DEBUG(logType, "deleted key 0x%016llx.texcache (unused for awhile)", i.key);
-            }
+        oglDevice->_textureData = textureData;
+        oglDevice->_vertexData = vertexData;
+        break;
+    }
+    }
+
+    dev->prepareDraw(state, type, count);
+    dev->drawPrimitive(state, type, count);
+    dev->endDraw(state);
+}
+
+static void __appendToBatch(const DecodedVertexList& list) {
+    DecodedVertexList& batch = primitiveBatch.list;
+    size_t base = batch.vertices.size();
+    batch.vertices.insert(batch.vertices.end(), list.vertices.begin(), list.vertices.end());
+
+    if (list.indexType == 0)
+        return;
+
+    size_t offset = batch.indices.size();
+    batch.indices.resize(offset + list.indexCount * sizeof(uint16_t));
+    batch.indexType = 2;
+    batch.indexCount += list.indexCount;
+
+    uint16_t *out = (uint16_t *) (batch.indices.data() + offset);
+    if (list.indexType == 1) {
+        for (int i = 0; i < list.indexCount; i++)
+            out[i] = uint16_t(base + list.indices[i]);
+    } else {
+        const uint16_t *in = (const uint16_t *) list.indices.data();
+        for (int i = 0; i < list.indexCount; i++)
+            out[i] = uint16_t(base + in[i]);
+    }
+}
+
+
+static void __submitVertexList(RenderDevice *dev, GPUState *state, int type, int count, const DecodedVertexList *vertexData) {
+    if (vertexData && __isSkinningRequired(state)) {
+        // the cached list is shared between draws, skinning writes into a per draw copy
+        static DecodedVertexList skinnedVertexData;
+        ProfilerScope scope(PROFILER_STAGE_SKINNING);
+        __skinVertexList(state, *vertexData, skinnedVertexData);
+        vertexData = &skinnedVertexData;
+    }
+
+    // clear mode rectangles only write constant values, they skip the vertex pipeline
+    ClearRectangle clear;
+    if (vertexData && __getClearRectangle(state, type, *vertexData, clear)) {
+        __FlushPrimitives(state);
+        if (dev->getDeviceType() == RENDERER_TYPE_OPENGL)
+            reinterpret_cast<RenderDeviceOpenGL *>(dev)->clear(state, clear);
+        else
+            __clearFramebufferMemory(state, clear);
+        return;
+    }
+
+    if (vertexData) {
+        static DecodedVertexList culledVertexData;
+        switch (__cullVertexList(state, type, *vertexData, culledVertexData)) {
+        case CULL_ALL:
+            return;
+        case CULL_COMPACTED:
+            vertexData = &culledVertexData;
+            break;
         }
+    }
 
-        if (!oglDevice->streamingTexture) {
-            textureData = __getTextureFromCache(state);
-        } else {
+    if (dev->getDeviceType() == RENDERER_TYPE_OPENGL && reinterpret_cast<RenderDeviceOpenGL *>(dev)->streamingTexture) {
+        // streaming textures are decoded again for every draw, nothing can be shared
+        __FlushPrimitives(state);
+        TextureData streamingTexture;
+        {
+            ProfilerScope scope(PROFILER_STAGE_DECODE);
             streamingTexture = __decodeTexture(state);
-            textureData = streamingTexture.isDirty ? nullptr : &streamingTexture;
         }
+        __drawVertexList(dev, state, type, count, vertexData, streamingTexture.isDirty ? nullptr : &streamingTexture);
+        return;
+    }
 
-        oglDevice->_textureData = textureData;
-        oglDevice->_vertexData = vertexData;
-        dev->prepareDraw(state, type, count);
-        break;
+    // textures inside a live render target are sampled from it instead of being decoded from VRAM
+    if (dev->getDeviceType() == RENDERER_TYPE_OPENGL && state->textureEnable && !state->clearModeEnable) {
+        auto oglDevice = reinterpret_cast<RenderDeviceOpenGL *>(dev);
+        oglDevice->_renderTargetTexture = oglDevice->framebufferManager.getTextureTarget(state, oglDevice->_renderTargetOffsetX, oglDevice->_renderTargetOffsetY);
+        if (oglDevice->_renderTargetTexture) {
+            __FlushPrimitives(state);
+            __drawVertexList(dev, state, type, count, vertexData, nullptr);
+            oglDevice->_renderTargetTexture = nullptr;
+            return;
+        }
+    }
+
+    TextureData *textureData = __getTextureFromCache(state);
+    if (!vertexData || !__isBatchablePrimitive(type) || state->clearModeEnable) {
+        __FlushPrimitives(state);
+        __drawVertexList(dev, state, type, count, vertexData, textureData);
+        return;
     }
+
+    PrimitiveBatch& batch = primitiveBatch;
+    if (batch.draws != 0 && (batch.type != type || batch.textureData != textureData ||
+        (batch.list.indexType != 0) != (vertexData->indexType != 0) ||
+        batch.list.vertices.size() + vertexData->vertices.size() > maxBatchVertices))
+        __FlushPrimitives(state);
+
+    if (batch.draws == 0) {
+        batch.type = type;
+        batch.textureData = textureData;
     }
+
+    __appendToBatch(*vertexData);
+    batch.count += count;
+    batch.draws++;
 }
 
-void __DrawPrimitive(GPUState *state, int type, int count) {
+void __SubmitPrimitive(GPUState *state, int type, int count) {
     RenderDevice *dev = getRenderDevice();
     if (!dev)
         return;
 
-    dev->drawPrimitive(state, type, count);
+    __submitVertexList(dev, state, type, count, __getListFromVertexCache(state, type, count));
 }
 
-void __EndDraw(GPUState *state) {
+void __SubmitPatch(GPUState *state, bool spline, uint32_t param) {
     RenderDevice *dev = getRenderDevice();
     if (!dev)
         return;
 
-    dev->endDraw(state);
+    const TessellatedPatch *patch = __getTessellatedPatch(state, spline, param);
+    if (!patch)
+        return;
+
+    __submitVertexList(dev, state, patch->primitiveType, patch->count, &patch->data);
 }
 
-void __openglUpdateFramebuffer(RenderDevice *device, int x, int y, int w, int h) {
+void __FlushPrimitives(GPUState *state) {
+    PrimitiveBatch& batch = primitiveBatch;
+    if (batch.draws == 0)
+        return;
+
+    if (RenderDevice *dev = getRenderDevice())
+        __drawVertexList(dev, state, batch.type, batch.count, &batch.list, batch.textureData);
 
+    batch.list.vertices.clear();
+    batch.list.indices.clear();
+    batch.list.indexType = 0;
+    batch.list.indexCount = 0;
+    batch.textureData = nullptr;
+    batch.count = 0;
+    batch.draws = 0;
+}
+
+bool __RenderDevicePresentsTarget(uint32_t address, uint32_t size) {
+    RenderDevice *device = getRenderDevice();
+    if (!device || device->getDeviceType() != RENDERER_TYPE_OPENGL)
+        return false;
+
+    // the CPU wrote over the GE output when its pages are newer than the last draw into the target
+    RenderDeviceOpenGL *dev = reinterpret_cast<RenderDeviceOpenGL *>(device);
+    RenderTarget *target = dev->framebufferManager.getDisplayTarget(address);
+    if (!target || target->address != __getFramebufferAddress(address) || Core::Memory::isWrittenSince(target->address, size, target->writeStamp))
+        return false;
+
+    dev->presentDisplayTexture = false;
+    return true;
+}
+
+void __openglUpdateFramebuffer(RenderDevice *device, const uint32_t *pixels, int x, int y, int w, int h) {
+    if (!device || device->getDeviceType() != RENDERER_TYPE_OPENGL)
+        return;
+
+    RenderDeviceOpenGL *dev = reinterpret_cast<RenderDeviceOpenGL *>(device);
+    if (!dev->validOpenGLState)
+        return;
+
+    dev->glState.bindTexture(dev->m_DisplayTexture);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 480);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, w, h, GL_RGBA, GL_UNSIGNED_BYTE, pixels + y * 480 + x);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    dev->presentDisplayTexture = true;
 }
 
 void __openglSetStreamingTextureDevice(RenderDevice *device, bool state) {
@@ -803,7 +1008,13 @@ void __openglRenderScreen(RenderDevice *device) {
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
     // glViewport(0, 0, 480*2, 272*2);
 
-    glBindTexture(GL_TEXTURE_2D, dev->m_FramebufferTexture);
+    GLuint texture = dev->m_DisplayTexture;
+    if (!dev->presentDisplayTexture) {
+        RenderTarget *target = dev->framebufferManager.getDisplayTarget(__displayGetFramebufferAddress());
+        texture = target ? target->colorTexture : 0;
+    }
+
+    glBindTexture(GL_TEXTURE_2D, texture);
     glBindVertexArray(dev->m_FramebufferVAO);
 
     glDisable(GL_DEPTH_TEST);
@@ -839,37 +1050,14 @@ void __openglDebugTexture(const char *texcache) {
     fread(buf, size, 1, f);
     fclose(f);
 
-    uint32_t fbo, rbo, tex;
     int w = 64, h = 64;
 
-    glGenFramebuffers(1, &fbo);
-    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
-    glGenTextures(1, &tex);
-    glBindTexture(GL_TEXTURE_2D, tex);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, w, h, 0, GL_RGBA, GL_UNSIGNED_SHORT_1_5_5_5_REV, buf);
+    // shown in the corner of the display texture until the next CPU framebuffer flip
+    dev->glState.bindTexture(dev->m_DisplayTexture);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, w, h, GL_RGBA, GL_UNSIGNED_SHORT_1_5_5_5_REV, buf);
     delete[] buf;
 
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, tex, 0);
-
-    glGenRenderbuffers(1, &rbo);
-    glBindRenderbuffer(GL_RENDERBUFFER, rbo);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, w, h);
-    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, rbo);
-
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
-    glBindTexture(GL_TEXTURE_2D, 0);
-
-    glDeleteFramebuffers(1, &dev->m_FramebufferObject);
-    glDeleteRenderbuffers(1, &dev->m_RenderBufferObject);
-    glDeleteTextures(1, &dev->m_FramebufferTexture);
-
-    dev->m_FramebufferObject = fbo;
-    dev->m_RenderBufferObject = rbo;
-    dev->m_FramebufferTexture = tex;
+    dev->presentDisplayTexture = true;
 }
 
 RenderDevice *createRenderDevice(RendererType type) {
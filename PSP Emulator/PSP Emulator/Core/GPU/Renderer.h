@@ -30,17 +30,20 @@ void destroyRenderDevice(RenderDevice *device);
 RenderDevice *getRenderDevice();
 void setRenderDevice(RenderDevice *device);
 
-void __openglUpdateFramebuffer(RenderDevice *device, int x, int y, int w, int h);
+// pixels is the whole RGBA display image, bottom-up with 480 pixels per row
+void __openglUpdateFramebuffer(RenderDevice *device, const uint32_t *pixels, int x, int y, int w, int h);
 void __openglRenderScreen(RenderDevice *device);
 void __openglSetStreamingTextureDevice(RenderDevice *device, bool state);
 void __openglDebugTexture(const char *texcache);
 
 void __RenderDeviceDisplayListBegin();
 void __RenderDeviceDisplayListEnd();
+void __RenderDeviceEndFrame();
+bool __RenderDevicePresentsTarget(uint32_t address, uint32_t size); // true if the GE output there is newer than VRAM, it's shown then
 
 void __DrawDebugPrimitive(GPUState *state, int type, int count);
-void __PrepareDraw(GPUState *state, int type, int count);
-void __DrawPrimitive(GPUState *state, int type, int count);
-void __EndDraw(GPUState *state);
+void __SubmitPrimitive(GPUState *state, int type, int count); // decodes the primitive and batches it
+void __SubmitPatch(GPUState *state, bool spline, uint32_t param); // tessellates a CMD_BEZIER / CMD_SPLINE control mesh and submits it
+void __FlushPrimitives(GPUState *state); // draws the batch, must run before the render state changes
 
 }
\ No newline at end of file
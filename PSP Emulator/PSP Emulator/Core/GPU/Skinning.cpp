@@ -0,0 +1,84 @@
+#include <Core/GPU/GPU.h>
+#include <Core/GPU/Skinning.h>
+
+#include <Core/Utility/SIMD.h>
+
+namespace Core::GPU {
+bool __isSkinningRequired(const GPUState *state) {
+    return !state->vertexInfo.tm && state->vertexInfo.wt != 0;
+}
+
+#if defined(SIMD_SSE2)
+// bone matrices are stored row major as x' = x * row0 + y * row1 + z * row2 + row3,
+// the weighted rows are summed first so each vertex is transformed only once
+static void __skinVertices(const GPUState *state, const VertexData *in, VertexData *out, size_t count) {
+    const int wc = state->vertexInfo.wc;
+
+    for (size_t i = 0; i < count; i++) {
+        const VertexData& src = in[i];
+        VertexData& dst = out[i];
+
+        __m128 row0 = _mm_setzero_ps(), row1 = _mm_setzero_ps(), row2 = _mm_setzero_ps(), row3 = _mm_setzero_ps();
+        for (int b = 0; b < wc; b++) {
+            if (src.w[b] == 0.f)
+                continue;
+
+            const float *m = state->boneMatrix[b].mData;
+            __m128 weight = _mm_set1_ps(src.w[b]);
+            row0 = _mm_add_ps(row0, _mm_mul_ps(_mm_loadu_ps(m + 0), weight));
+            row1 = _mm_add_ps(row1, _mm_mul_ps(_mm_loadu_ps(m + 4), weight));
+            row2 = _mm_add_ps(row2, _mm_mul_ps(_mm_loadu_ps(m + 8), weight));
+            row3 = _mm_add_ps(row3, _mm_mul_ps(_mm_loadu_ps(m + 12), weight));
+        }
+
+        alignas(16) float result[4];
+
+        __m128 position = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(src.position.x), row0), _mm_mul_ps(_mm_set1_ps(src.position.y), row1)),
+                                     _mm_add_ps(_mm_mul_ps(_mm_set1_ps(src.position.z), row2), row3));
+        _mm_store_ps(result, position);
+        dst.position = glm::vec3(result[0], result[1], result[2]);
+
+        __m128 normal = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(src.normal.x), row0), _mm_mul_ps(_mm_set1_ps(src.normal.y), row1)),
+                                   _mm_mul_ps(_mm_set1_ps(src.normal.z), row2));
+        _mm_store_ps(result, normal);
+        dst.normal = glm::vec3(result[0], result[1], result[2]);
+    }
+}
+#else
+static void __skinVertices(const GPUState *state, const VertexData *in, VertexData *out, size_t count) {
+    const int wc = state->vertexInfo.wc;
+
+    for (size_t i = 0; i < count; i++) {
+        const VertexData& src = in[i];
+        VertexData& dst = out[i];
+        float m[16] {};
+
+        for (int b = 0; b < wc; b++) {
+            if (src.w[b] == 0.f)
+                continue;
+
+            for (int j = 0; j < 16; j++)
+                m[j] += state->boneMatrix[b].mData[j] * src.w[b];
+        }
+
+        const glm::vec3& p = src.position;
+        const glm::vec3& n = src.normal;
+        dst.position = glm::vec3(p.x * m[0] + p.y * m[4] + p.z * m[8] + m[12],
+                                 p.x * m[1] + p.y * m[5] + p.z * m[9] + m[13],
+                                 p.x * m[2] + p.y * m[6] + p.z * m[10] + m[14]);
+        dst.normal = glm::vec3(n.x * m[0] + n.y * m[4] + n.z * m[8],
+                               n.x * m[1] + n.y * m[5] + n.z * m[9],
+                               n.x * m[2] + n.y * m[6] + n.z * m[10]);
+    }
+}
+#endif
+
+void __skinVertexList(const GPUState *state, const DecodedVertexList& in, DecodedVertexList& out) {
+    out.vertices = in.vertices;
+    out.indices = in.indices;
+    out.indexType = in.indexType;
+    out.indexCount = in.indexCount;
+
+    __skinVertices(state, in.vertices.data(), out.vertices.data(), in.vertices.size());
+}
+}
\ No newline at end of file
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <Core/GPU/VertexDecoder.h>
+
+namespace Core::GPU {
+struct GPUState;
+
+bool __isSkinningRequired(const GPUState *state);
+
+// transforms the positions and normals of a decoded list by the bone matrices blended
+// with each vertex weights, the index list is carried over untouched
+void __skinVertexList(const GPUState *state, const DecodedVertexList& in, DecodedVertexList& out);
+}
\ No newline at end of file
@@ -0,0 +1,365 @@
+#include <Core/GPU/GPU.h>
+#include <Core/GPU/Tessellation.h>
+#include <Core/GPU/GEConstants.h>
+#include <Core/GPU/GPUProfiler.h>
+
+#include <Core/Utility/SIMD.h>
+#include <Core/Utility/Hash.h>
+
+#include <Core/Logger.h>
+
+#include <unordered_map>
+#include <algorithm>
+#include <vector>
+
+namespace Core::GPU {
+static const char *logType = "Tessellation";
+
+static std::unordered_map<uint64_t, TessellatedPatch> tessellationCache;
+static size_t tessellationCacheMemorySize;
+static constexpr size_t tessellationCacheBudget = 16 * 1024 * 1024;
+static uint64_t tessellationCacheFrame;
+
+static constexpr uint64_t TESSELLATION_CACHE_MAX_FRAME_AGE = 120;
+static constexpr size_t maxPatchVertices = 0x10000; // generated indices are 16-bit
+
+// control point attributes packed in lanes of four so a weighted sum is a handful of vector
+// multiply adds: position + u, v + normal, color, then the eight skinning weights
+static constexpr int controlPointLanes = 5;
+
+struct alignas(16) ControlPoint {
+    float v[controlPointLanes * 4];
+};
+
+// the four basis weights of one sample along u or v and the first control point they apply to
+struct alignas(16) BasisSample {
+    float weights[4];
+    int first;
+    float parameter; // used as the texture coordinate when the vertex type has none
+};
+
+static ControlPoint __packControlPoint(const VertexData& vertex) {
+    ControlPoint point;
+    float *v = point.v;
+    v[0] = vertex.position.x; v[1] = vertex.position.y; v[2] = vertex.position.z; v[3] = vertex.uv.x;
+    v[4] = vertex.uv.y; v[5] = vertex.normal.x; v[6] = vertex.normal.y; v[7] = vertex.normal.z;
+    v[8] = vertex.color.x; v[9] = vertex.color.y; v[10] = vertex.color.z; v[11] = vertex.color.w;
+    std::copy(vertex.w, vertex.w + 8, v + 12);
+    return point;
+}
+
+static void __unpackControlPoint(const float *v, VertexData& vertex) {
+    vertex.position = glm::vec3(v[0], v[1], v[2]);
+    vertex.uv = glm::vec2(v[3], v[4]);
+    vertex.normal = glm::vec3(v[5], v[6], v[7]);
+    vertex.color = glm::vec4(v[8], v[9], v[10], v[11]);
+    std::copy(v + 12, v + 20, vertex.w);
+}
+
+// cubic bernstein weights ((1-t)^3, 3t(1-t)^2, 3t^2(1-t), t^3)
+static void __bernsteinWeights(float t, float weights[4]) {
+#if defined(SIMD_SSE2)
+    const float s = 1.f - t;
+    __m128 a = _mm_setr_ps(s, t, t, t);
+    __m128 b = _mm_setr_ps(s, s, t, t);
+    __m128 c = _mm_setr_ps(s, s, s, t);
+    __m128 scale = _mm_setr_ps(1.f, 3.f, 3.f, 1.f);
+    _mm_storeu_ps(weights, _mm_mul_ps(_mm_mul_ps(a, b), _mm_mul_ps(c, scale)));
+#else
+    const float s = 1.f - t;
+    weights[0] = s * s * s;
+    weights[1] = 3.f * t * s * s;
+    weights[2] = 3.f * t * t * s;
+    weights[3] = t * t * t;
+#endif
+}
+
+// uniform cubic knots, an open end repeats its boundary knot so the curve reaches the end control point
+static void __splineKnots(int count, int type, std::vector<float>& knots) {
+    const int n = count - 1;
+    knots.assign(n + 5, 0.f);
+    for (int i = 0; i < n - 1; i++)
+        knots[i + 3] = float(i);
+
+    if ((type & 1) == 0) {
+        knots[0] = -3.f;
+        knots[1] = -2.f;
+        knots[2] = -1.f;
+    }
+
+    if ((type & 2) == 0) {
+        knots[n + 2] = float(n - 1);
+        knots[n + 3] = float(n);
+        knots[n + 4] = float(n + 1);
+    } else {
+        knots[n + 2] = float(n - 2);
+        knots[n + 3] = float(n - 2);
+        knots[n + 4] = float(n - 2);
+    }
+}
+
+// cox-de boor recursion for the four cubic basis functions non zero in knots[span, span + 1]
+static void __splineWeights(const std::vector<float>& knots, int span, float x, float weights[4]) {
+    float left[4], right[4];
+    weights[0] = 1.f;
+
+    for (int p = 1; p <= 3; p++) {
+        left[p] = x - knots[span + 1 - p];
+        right[p] = knots[span + p] - x;
+
+        float saved = 0.f;
+        for (int r = 0; r < p; r++) {
+            float denominator = right[r + 1] + left[p - r];
+            float temp = denominator != 0.f ? weights[r] / denominator : 0.f;
+            weights[r] = saved + right[r + 1] * temp;
+            saved = left[p - r] * temp;
+        }
+        weights[p] = saved;
+    }
+}
+
+// samples along one direction of the mesh, the patches share their edge samples
+static std::vector<BasisSample> __getBasisSamples(bool spline, int count, int type, int divisions) {
+    const int patches = spline ? count - 3 : (count - 1) / 3;
+    std::vector<BasisSample> samples(size_t(patches) * divisions + 1);
+
+    std::vector<float> knots;
+    if (spline)
+        __splineKnots(count, type, knots);
+
+    for (size_t i = 0; i < samples.size(); i++) {
+        int patch = std::min(int(i / divisions), patches - 1);
+        float t = float(int(i) - patch * divisions) / float(divisions);
+
+        BasisSample& sample = samples[i];
+        sample.parameter = float(patch) + t;
+        if (spline) {
+            const int span = patch + 3;
+            __splineWeights(knots, span, knots[span] + t * (knots[span + 1] - knots[span]), sample.weights);
+            sample.first = patch;
+        } else {
+            __bernsteinWeights(t, sample.weights);
+            sample.first = patch * 3;
+        }
+    }
+    return samples;
+}
+
+#if defined(SIMD_SSE2)
+static void __evaluateMesh(const ControlPoint *points, int ucount, const std::vector<BasisSample>& uSamples,
+                           const std::vector<BasisSample>& vSamples, int lanes, VertexData *out) {
+    for (const BasisSample& v : vSamples) {
+        for (const BasisSample& u : uSamples) {
+            __m128 sum[controlPointLanes] {};
+
+            for (int j = 0; j < 4; j++) {
+                const ControlPoint *row = points + size_t(v.first + j) * ucount + u.first;
+                __m128 rowSum[controlPointLanes] {};
+
+                for (int i = 0; i < 4; i++) {
+                    __m128 weight = _mm_set1_ps(u.weights[i]);
+                    for (int l = 0; l < lanes; l++)
+                        rowSum[l] = _mm_add_ps(rowSum[l], _mm_mul_ps(_mm_load_ps(row[i].v + l * 4), weight));
+                }
+
+                __m128 weight = _mm_set1_ps(v.weights[j]);
+                for (int l = 0; l < lanes; l++)
+                    sum[l] = _mm_add_ps(sum[l], _mm_mul_ps(rowSum[l], weight));
+            }
+
+            alignas(16) float result[controlPointLanes * 4] {};
+            for (int l = 0; l < lanes; l++)
+                _mm_store_ps(result + l * 4, sum[l]);
+            __unpackControlPoint(result, *out++);
+        }
+    }
+}
+#else
+static void __evaluateMesh(const ControlPoint *points, int ucount, const std::vector<BasisSample>& uSamples,
+                           const std::vector<BasisSample>& vSamples, int lanes, VertexData *out) {
+    for (const BasisSample& v : vSamples) {
+        for (const BasisSample& u : uSamples) {
+            float result[controlPointLanes * 4] {};
+
+            for (int j = 0; j < 4; j++) {
+                const ControlPoint *row = points + size_t(v.first + j) * ucount + u.first;
+                for (int i = 0; i < 4; i++) {
+                    float weight = u.weights[i] * v.weights[j];
+                    for (int k = 0; k < lanes * 4; k++)
+                        result[k] += row[i].v[k] * weight;
+                }
+            }
+            __unpackControlPoint(result, *out++);
+        }
+    }
+}
+#endif
+
+static void __generateIndices(TessellatedPatch& patch, int columns, int rows, uint8_t primitive, bool face) {
+    std::vector<uint16_t> indices;
+    auto vertex = [&](int x, int y) { return uint16_t(y * columns + x); };
+
+    switch (primitive) {
+    case 0:
+        patch.primitiveType = GE_PRIM_TRIANGLES;
+        indices.reserve(size_t(columns - 1) * (rows - 1) * 6);
+        for (int y = 0; y < rows - 1; y++) {
+            for (int x = 0; x < columns - 1; x++) {
+                uint16_t a = vertex(x, y), b = vertex(x + 1, y), c = vertex(x, y + 1), d = vertex(x + 1, y + 1);
+                if (face)
+                    indices.insert(indices.end(), { a, c, b, b, c, d });
+                else
+                    indices.insert(indices.end(), { a, b, c, c, b, d });
+            }
+        }
+        break;
+    case 1:
+        patch.primitiveType = GE_PRIM_LINES;
+        for (int y = 0; y < rows; y++) {
+            for (int x = 0; x < columns; x++) {
+                if (x + 1 < columns)
+                    indices.insert(indices.end(), { vertex(x, y), vertex(x + 1, y) });
+                if (y + 1 < rows)
+                    indices.insert(indices.end(), { vertex(x, y), vertex(x, y + 1) });
+            }
+        }
+        break;
+    default:
+        // points draw the evaluated vertices as they are
+        patch.primitiveType = GE_PRIM_POINTS;
+        patch.data.indexType = 0;
+        patch.data.indexCount = 0;
+        patch.count = int(patch.data.vertices.size());
+        return;
+    }
+
+    patch.data.indices.resize(indices.size() * sizeof(uint16_t));
+    std::copy(indices.begin(), indices.end(), (uint16_t *) patch.data.indices.data());
+    patch.data.indexType = 2;
+    patch.data.indexCount = int(indices.size());
+    patch.count = int(indices.size());
+}
+
+static uint64_t __getPatchHash(const GPUState *state, bool spline, uint32_t param, const std::vector<ControlPoint>& points) {
+    const GPUState::PatchInfo& info = state->patchInfo;
+    const uint32_t settings[6] = { uint32_t(spline), param, uint32_t(info.divisionS) | uint32_t(info.divisionT) << 8,
+                                   info.primitive, info.face, state->vertexInfo.param };
+
+    uint64_t hash = Core::Utility::hash64(points.data(), points.size() * sizeof(ControlPoint));
+    return Core::Utility::hashCombine(hash, Core::Utility::hash64(settings, sizeof settings));
+}
+
+const TessellatedPatch *__getTessellatedPatch(const GPUState *state, bool spline, uint32_t param) {
+    const int ucount = param & 0xFF;
+    const int vcount = (param >> 8) & 0xFF;
+    const int utype = (param >> 16) & 3;
+    const int vtype = (param >> 18) & 3;
+
+    if (ucount < 4 || vcount < 4 || (!spline && ((ucount - 1) % 3 != 0 || (vcount - 1) % 3 != 0))) {
+        LOG_ERROR(logType, "invalid %s control mesh %dx%d", spline ? "spline" : "bezier", ucount, vcount);
+        return nullptr;
+    }
+
+    const int count = ucount * vcount;
+    const DecodedVertexList *controlMesh = __getListFromVertexCache(state, GE_PRIM_POINTS, count);
+    if (!controlMesh || controlMesh->vertices.empty())
+        return nullptr;
+
+    // indexed meshes are resolved so the control points are laid out row by row
+    std::vector<ControlPoint> points(count);
+    for (int i = 0; i < count; i++) {
+        size_t index = i;
+        if (controlMesh->indexType == 1)
+            index = controlMesh->indices[i];
+        else if (controlMesh->indexType == 2)
+            index = ((const uint16_t *) controlMesh->indices.data())[i];
+
+        if (index >= controlMesh->vertices.size()) {
+            LOG_ERROR(logType, "control point %d out of range", i);
+            return nullptr;
+        }
+        points[i] = __packControlPoint(controlMesh->vertices[index]);
+    }
+
+    uint64_t hash = __getPatchHash(state, spline, param, points);
+    if (auto it = tessellationCache.find(hash); it != tessellationCache.end()) {
+        it->second.lastUsedFrame = tessellationCacheFrame;
+        return &it->second;
+    }
+
+    ProfilerScope scope(PROFILER_STAGE_DECODE);
+
+    const int upatches = spline ? ucount - 3 : (ucount - 1) / 3;
+    const int vpatches = spline ? vcount - 3 : (vcount - 1) / 3;
+    int divisionS = std::clamp<int>(state->patchInfo.divisionS, 1, MAX_PATCH_DIVS);
+    int divisionT = std::clamp<int>(state->patchInfo.divisionT, 1, MAX_PATCH_DIVS);
+
+    // large meshes are tessellated coarser so the indices still fit in 16 bits
+    while (size_t(upatches * divisionS + 1) * size_t(vpatches * divisionT + 1) > maxPatchVertices && (divisionS > 1 || divisionT > 1)) {
+        if (divisionS >= divisionT)
+            divisionS--;
+        else
+            divisionT--;
+    }
+
+    std::vector<BasisSample> uSamples = __getBasisSamples(spline, ucount, utype, divisionS);
+    std::vector<BasisSample> vSamples = __getBasisSamples(spline, vcount, vtype, divisionT);
+    const int columns = int(uSamples.size()), rows = int(vSamples.size());
+
+    TessellatedPatch& patch = tessellationCache[hash];
+    patch.data.vertices.resize(size_t(columns) * rows);
+
+    // the weights only need evaluating when they're used for skinning
+    const int lanes = state->vertexInfo.wt != 0 ? controlPointLanes : 3;
+    __evaluateMesh(points.data(), ucount, uSamples, vSamples, lanes, patch.data.vertices.data());
+
+    // without texture coordinates the patch parameters are used
+    if (state->vertexInfo.tt == 0) {
+        for (int y = 0; y < rows; y++) {
+            for (int x = 0; x < columns; x++)
+                patch.data.vertices[size_t(y) * columns + x].uv = glm::vec2(uSamples[x].parameter, vSamples[y].parameter);
+        }
+    }
+
+    __generateIndices(patch, columns, rows, state->patchInfo.primitive, state->patchInfo.face);
+    patch.lastUsedFrame = tessellationCacheFrame;
+    tessellationCacheMemorySize += patch.getMemorySize();
+    return &patch;
+}
+
+void __updateTessellationCache() {
+    for (auto it = tessellationCache.begin(); it != tessellationCache.end(); ) {
+        if (it->second.lastUsedFrame + TESSELLATION_CACHE_MAX_FRAME_AGE < tessellationCacheFrame) {
+            tessellationCacheMemorySize -= it->second.getMemorySize();
+            it = tessellationCache.erase(it);
+            continue;
+        }
+        it++;
+    }
+
+    // animated meshes produce a new entry every frame, the oldest go first
+    if (tessellationCacheMemorySize > tessellationCacheBudget) {
+        std::vector<std::pair<uint64_t, uint64_t>> entries; // (last used frame, hash)
+        entries.reserve(tessellationCache.size());
+        for (auto& i : tessellationCache)
+            entries.emplace_back(i.second.lastUsedFrame, i.first);
+
+        std::sort(entries.begin(), entries.end());
+        for (auto& [frame, hash] : entries) {
+            if (tessellationCacheMemorySize <= tessellationCacheBudget || frame == tessellationCacheFrame)
+                break;
+
+            auto it = tessellationCache.find(hash);
+            tessellationCacheMemorySize -= it->second.getMemorySize();
+            tessellationCache.erase(it);
+        }
+    }
+
+    tessellationCacheFrame++;
+}
+
+void __clearTessellationCache() {
+    tessellationCache.clear();
+    tessellationCacheMemorySize = 0;
+}
+}
\ No newline at end of file
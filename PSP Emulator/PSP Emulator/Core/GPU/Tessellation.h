@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+
+#include <Core/GPU/VertexDecoder.h>
+
+namespace Core::GPU {
+struct GPUState;
+
+struct TessellatedPatch {
+    DecodedVertexList data;
+    int primitiveType; // GE_PRIM_TRIANGLES, GE_PRIM_LINES or GE_PRIM_POINTS from the patch primitive
+    int count;
+    uint64_t lastUsedFrame;
+
+    size_t getMemorySize() const {
+        return data.vertices.capacity() * sizeof(VertexData) + data.indices.capacity();
+    }
+};
+
+// evaluates the bezier or spline control mesh at the vertex list address into a list the normal
+// vertex pipeline draws, param is the one of CMD_BEZIER / CMD_SPLINE. results are cached by the
+// decoded control points and the patch state, nullptr if the mesh is malformed
+const TessellatedPatch *__getTessellatedPatch(const GPUState *state, bool spline, uint32_t param);
+void __updateTessellationCache(); // called once per frame, evicts old entries and keeps the cache within budget
+void __clearTessellationCache();
+}
\ No newline at end of file
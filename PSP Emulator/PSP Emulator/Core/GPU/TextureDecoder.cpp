@@ -1,5 +1,8 @@
 #include <Core/GPU/TextureDecoder.h>
 #include <Core/GPU/GEConstants.h>
+#include <Core/GPU/DXTBlock.h>
+#include <Core/GPU/GPUProfiler.h>
+#include <Core/GPU/Renderer.h>
 
 #include <Core/Logger.h>
 
@@ -7,37 +10,56 @@
 
 #include <Core/Timing.h>
 
+#include <Core/Utility/SIMD.h>
+#include <Core/Utility/Hash.h>
+#include <Core/Utility/Arena.h>
+#include <Core/Utility/ThreadPool.h>
+
 #include <GL/glew.h>
 
 #include <vector>
 #include <unordered_map>
+#include <algorithm>
+#include <cstring>
+#include <chrono>
+#include <future>
+#include <memory>
 
 namespace Core::GPU {
 static const char *logType = "TextureDecoder";
 
 std::unordered_map<uint64_t, TextureData> textureDataCache;
+static Core::DS::LRU<TextureData, &TextureData::lruNode> textureLRU;
+static size_t textureCacheMemorySize;
+static size_t textureCacheBudget = 128 * 1024 * 1024;
+
+static size_t getDecodedTextureSize(const GPUState::TextureInfo& info) {
+    size_t size = 0;
+    for (int i = 0; i < info.textureNumMipMaps; i++)
+        size += size_t(info.textureBufferWidth[i]) * info.textureHeight[i] * 4;
+    return size;
+}
 
-static uint8_t buffer[8][512 * 512 * 4];
-static uint8_t swizzledBuffer[8][512 * 512 * 4];
+static TextureData *insertTexture(uint64_t key, const TextureData& data) {
+    TextureData *entry = &(textureDataCache[key] = data);
+    entry->memorySize = getDecodedTextureSize(entry->textureInfo);
+    textureCacheMemorySize += entry->memorySize;
+    textureLRU.touch(entry);
+    return entry;
+}
 
-static constexpr int textureUpdateTimeConstant() {
-    return 30000;
+static void eraseTexture(std::unordered_map<uint64_t, TextureData>::iterator it) {
+    textureLRU.remove(&it->second);
+    textureCacheMemorySize -= it->second.memorySize;
+    textureDataCache.erase(it);
 }
 
-std::vector<TextureCacheData> __updateTextureCache() {
-    std::vector<TextureCacheData> data;
-    
-    for (auto it = textureDataCache.begin(); it != textureDataCache.end(); ) {
-        TextureData *_data = &it->second;
+void setTextureCacheBudget(size_t bytes) {
+    textureCacheBudget = bytes;
+}
 
-        if (Core::Timing::getSystemTimeMilliseconds() >= _data->timestamp + textureUpdateTimeConstant()) {
-            data.push_back(TextureCacheData { .handle = _data->handle, .key = _data->key });
-            it = textureDataCache.erase(it);
-            continue;
-        }
-        it++;
-    }
-    return data;
+size_t getTextureCacheMemorySize() {
+    return textureCacheMemorySize;
 }
 
 std::vector<TextureData *> getTextureDataList() {
@@ -47,48 +69,79 @@ std::vector<TextureData *> getTextureDataList() {
     return _t;
 }
 
-static uint64_t getTextureHashedKey(const GPUState::TextureInfo *data) {
-    uint64_t hash = 0;
+static uint32_t getTextureLevelSize(const GPUState::TextureInfo *data, int level) {
+    uint32_t width = std::max(data->textureBufferWidth[level], data->textureWidth[level]);
+    uint32_t height = data->textureHeight[level];
+
+    switch (data->textureStorage) {
+    case TPSM_PIXEL_STORAGE_MODE_16BIT_BGR5650:
+    case TPSM_PIXEL_STORAGE_MODE_16BIT_ABGR5551:
+    case TPSM_PIXEL_STORAGE_MODE_16BIT_ABGR4444:
+    case TPSM_PIXEL_STORAGE_MODE_16BIT_INDEXED:
+        return width * height * 2;
+    case TPSM_PIXEL_STORAGE_MODE_32BIT_ABGR8888:
+    case TPSM_PIXEL_STORAGE_MODE_32BIT_INDEXED:
+        return width * height * 4;
+    case TPSM_PIXEL_STORAGE_MODE_DXT1:
+        return ((width + 3) / 4) * ((height + 3) / 4) * 8;
+    case TPSM_PIXEL_STORAGE_MODE_DXT3:
+    case TPSM_PIXEL_STORAGE_MODE_DXT5:
+        return ((width + 3) / 4) * ((height + 3) / 4) * 16;
+    case TPSM_PIXEL_STORAGE_MODE_4BIT_INDEXED:
+        return width * height / 2;
+    case TPSM_PIXEL_STORAGE_MODE_8BIT_INDEXED:
+        return width * height;
+    }
+    return 0;
+}
+
+static uint32_t getCLUTSize(const GPUState::TextureInfo *data) {
+    uint32_t maxPalette = data->clutCsa + (data->clutShared ? 0 : data->textureNumMipMaps - 1);
+    uint32_t entries = ((maxPalette << 4) | data->clutMsk) + 1;
+    return entries * (data->clutMode == CMODE_FORMAT_32BIT_ABGR8888 ? 4 : 2);
+}
+
+static bool isIndexedTexture(const GPUState::TextureInfo *data) {
+    return data->textureStorage >= GE_TFMT_CLUT4 && data->textureStorage <= GE_TFMT_CLUT32;
+}
+
+// the cache is keyed by where and how a texture is stored, its contents are validated with
+// the memory page write stamps instead of being hashed on every bind
+static uint64_t getTextureKey(const GPUState::TextureInfo *data) {
+    uint32_t key[8 * 4 + 8] {};
+    int n = 0;
+
     for (int i = 0; i < data->textureNumMipMaps; ++i) {
-        uint32_t n = std::max(data->textureBufferWidth[i], data->textureWidth[i]) * data->textureHeight[i];
-        switch (data->textureStorage) {
-        case TPSM_PIXEL_STORAGE_MODE_16BIT_BGR5650:
-        case TPSM_PIXEL_STORAGE_MODE_16BIT_ABGR5551:
-        case TPSM_PIXEL_STORAGE_MODE_16BIT_ABGR4444:
-        case TPSM_PIXEL_STORAGE_MODE_16BIT_INDEXED:
-            n /= 2;
-            break;
-        case TPSM_PIXEL_STORAGE_MODE_32BIT_ABGR8888:
-        case TPSM_PIXEL_STORAGE_MODE_32BIT_INDEXED:
-        break;
-        case TPSM_PIXEL_STORAGE_MODE_DXT1:
-            n = ((data->textureWidth[i] + 3) / 4)*((data->textureWidth[i] + 3) / 4)*2;
-            break;
-        case TPSM_PIXEL_STORAGE_MODE_DXT3:
-        case TPSM_PIXEL_STORAGE_MODE_DXT5:
-            n = ((data->textureWidth[i] + 3) / 4)*((data->textureWidth[i] + 3) / 4)*4;
-            break;
-        case TPSM_PIXEL_STORAGE_MODE_4BIT_INDEXED:
-            n /= 8;
-            break;
-        case TPSM_PIXEL_STORAGE_MODE_8BIT_INDEXED:
-            n /= 4;
-            break;
-        }
+        key[n++] = data->textureBasePointer[i];
+        key[n++] = data->textureBufferWidth[i];
+        key[n++] = data->textureWidth[i];
+        key[n++] = data->textureHeight[i];
+    }
 
-        uint64_t *p = (uint64_t *) Memory::getPointerUnchecked(data->textureBasePointer[i]);
-        if (!p) {
-            LOG_ERROR(logType, "invalid hash key texture base pointer level %d addr 0x%08x", i, data->textureBasePointer[i]);
-            return ~0uLL;
-        }
+    key[n++] = data->textureNumMipMaps;
+    key[n++] = data->textureStorage;
+    key[n++] = data->textureSwizzle;
 
-        for (uint64_t *e = p + (n/2); p < e; p++) {
-            hash += *p;
-        }
+    if (isIndexedTexture(data)) {
+        key[n++] = data->clutAddress;
+        key[n++] = data->clutMode;
+        key[n++] = data->clutShared;
+        key[n++] = data->clutCsa | data->clutSft << 8 | data->clutMsk << 16;
+    }
+    return Core::Utility::hash64(key, n * sizeof(uint32_t));
+}
 
-        hash += data->textureStorage + data->clutMode + data->clutAddress + data->textureHeight[i] * data->textureWidth[i] + data->textureBasePointer[i];
+static bool isTextureWritten(const TextureData *data) {
+    const GPUState::TextureInfo& info = data->textureInfo;
+
+    for (int i = 0; i < info.textureNumMipMaps; ++i) {
+        if (Core::Memory::isWrittenSince(info.textureBasePointer[i], getTextureLevelSize(&info, i), data->writeStamp))
+            return true;
     }
-    return hash;
+
+    if (isIndexedTexture(&info) && Core::Memory::isWrittenSince(info.clutAddress, getCLUTSize(&info), data->writeStamp))
+        return true;
+    return false;
 }
 
 uint32_t TextureData::getTexturePixelType() {
@@ -99,8 +152,9 @@ uint32_t TextureData::getTexturePixelType() {
         GL_UNSIGNED_BYTE,
     };
 
-    if (textureInfo.textureStorage >= 4 && textureInfo.textureStorage <= 7) {
-        return storage[textureInfo.clutMode];
+    // CLUT and DXT textures are expanded to ABGR8888 whatever the palette format is
+    if (textureInfo.textureStorage >= 4 && textureInfo.textureStorage <= 10) {
+        return GL_UNSIGNED_BYTE;
     } else if (textureInfo.textureStorage < 4) {
         return storage[textureInfo.textureStorage];
     } else
@@ -113,65 +167,6 @@ TextureData *__getTextureByKey(const uint64_t& key) {
     return it != textureDataCache.end() ? &it->second : nullptr;
 }
 
-static bool requiredToUpdate(const TextureData *data) {
-    return Core::Timing::getSystemTimeMilliseconds() >= data->timestamp + textureUpdateTimeConstant();
-}
-
-TextureData *__getTextureFromCache(const GPUState *state) {
-    const GPUState::TextureInfo& info = state->textureInfo;
-
-    if (!state->textureEnable || state->clearModeEnable)
-        return nullptr;
-
-    uint64_t key = getTextureHashedKey(&state->textureInfo);
-    
-    if (key == -1)
-        return nullptr;
-
-    TextureData data;
-
-    auto it = textureDataCache.find(key);
-    if (it != textureDataCache.end()) {
-        it->second.forceUpdate = requiredToUpdate(&it->second);
-        if (!it->second.isDirty && !it->second.forceUpdate) {
-            it->second.timestamp += textureUpdateTimeConstant();
-            if (!memcmp(&it->second.textureInfo, &info, sizeof info)) { // lazy 
-                return &it->second;
-            }
-        }
-
-        uint64_t oldHandle = it->second.handle;
-        it->second.isDirty = true;
-        textureDataCache.erase(it);
-        // LOG_DEBUG(logType, "dirty 0x%016llx.texcache remaking...", key);
-
-        data = __decodeTexture(state, key);
-        if (data.isDirty == true) {
-            LOG_ERROR(logType, "can't save texture again, key 0x%016llx invalid decoding", key);
-            return nullptr;
-        }
-        
-        data.handle = oldHandle;
-        data.forceUpdate = true;
-        textureDataCache[key] = data;
-        return &textureDataCache[key];
-    }
-
-    data = __decodeTexture(state, key);
-    if (data.isDirty == true) {
-        LOG_ERROR(logType, "can't save texture, key 0x%016llx invalid decoding", key);
-        return nullptr;
-    }
-
-    textureDataCache[key] = data;
-    LOG_DEBUG(logType, "saved 0x%016llx.texcache", key);
-    return &textureDataCache[key];
-}
-
-static inline uint32_t getCLUTIndex(uint32_t index, uint32_t csa, int sft, uint32_t msk) {
-    return ((index >> sft) & msk) | (csa << 4);
-}
-
 static inline void __fastUnswizzle(uint8_t *out, const uint8_t *in, int32_t width, int32_t height) {
     int32_t blockx, blocky;
     int32_t j;
@@ -204,459 +199,664 @@ static inline void __fastUnswizzle(uint8_t *out, const uint8_t *in, int32_t widt
     }
 }
 
-template<int _Bpp>
-static void __unswizzleTexture(const GPUState::TextureInfo& info, void *outBuffer, const void *inBuffer, int level) {
-    switch (_Bpp) {
-    case  4: __fastUnswizzle((uint8_t *)outBuffer, (const uint8_t *)inBuffer, info.textureBufferWidth[level]/2, info.textureHeight[level]); break;
-    case  8: __fastUnswizzle((uint8_t *)outBuffer, (const uint8_t *)inBuffer, info.textureBufferWidth[level]  , info.textureHeight[level]); break;
-    case 16: __fastUnswizzle((uint8_t *)outBuffer, (const uint8_t *)inBuffer, info.textureBufferWidth[level]*2, info.textureHeight[level]); break;
-    case 32: __fastUnswizzle((uint8_t *)outBuffer, (const uint8_t *)inBuffer, info.textureBufferWidth[level]*4, info.textureHeight[level]); break;
+// CLUT textures are always expanded to ABGR8888, the palette is converted once per level
+// and the csa/shift/mask lookup is folded into it so the decoders can index it directly
+struct CLUTLookup {
+    alignas(32) uint32_t clut[256];  // palette indexed by ((index >> sft) & msk), csa already applied
+    alignas(32) uint32_t table[256]; // raw 4/8 bit index to color
+    alignas(16) uint8_t planes[4][16]; // CLUT4 table split into byte planes for pshufb
+    uint32_t sft, msk;
+};
+
+// a level is prepared on the emulation thread and only read while its rows are decoded
+struct TextureLevel {
+    const uint8_t *input;
+    uint8_t *output;
+    const CLUTLookup *lookup;
+    int level;
+};
+
+struct TextureDecodeJob {
+    GPUState::TextureInfo info;
+    TextureData data;
+    TextureLevel levels[8];
+    std::unique_ptr<CLUTLookup[]> palettes; // copies for decodes that outlive the current draw
+};
+
+static inline uint32_t getCLUTIndex(uint32_t index, uint32_t csa, int sft, uint32_t msk) {
+    return ((index >> sft) & msk) | (csa << 4);
+}
+
+static inline uint32_t __convertCLUTColor(uint16_t c, uint32_t clutMode) {
+    uint32_t r, g, b, a;
+    switch (clutMode) {
+    case CMODE_FORMAT_16BIT_BGR5650:
+        r = c & 0x1F; g = (c >> 5) & 0x3F; b = c >> 11;
+        r = (r << 3) | (r >> 2); g = (g << 2) | (g >> 4); b = (b << 3) | (b >> 2); a = 0xFF;
+        break;
+    case CMODE_FORMAT_16BIT_ABGR5551:
+        r = c & 0x1F; g = (c >> 5) & 0x1F; b = (c >> 10) & 0x1F;
+        r = (r << 3) | (r >> 2); g = (g << 3) | (g >> 2); b = (b << 3) | (b >> 2); a = (c >> 15) ? 0xFF : 0;
+        break;
+    default:
+        r = (c & 0xF) * 0x11; g = ((c >> 4) & 0xF) * 0x11; b = ((c >> 8) & 0xF) * 0x11; a = (c >> 12) * 0x11;
+        break;
     }
+    return r | (g << 8) | (b << 16) | (a << 24);
 }
 
-static bool decodeCLUT4(TextureData& data, const GPUState::TextureInfo& info) {
-    for (int level = 0; level < info.textureNumMipMaps; level++) {
-        if (info.clutAddress == 0) {
-            return false;
-        }
+#if defined(SIMD_SSE2)
+static inline __m128i __expand5(__m128i v) {
+    return _mm_or_si128(_mm_slli_epi16(v, 3), _mm_srli_epi16(v, 2));
+}
 
-        void *inputPointer = Core::Memory::getPointerUnchecked(info.textureBasePointer[level]);
+static inline __m128i __expand6(__m128i v) {
+    return _mm_or_si128(_mm_slli_epi16(v, 2), _mm_srli_epi16(v, 4));
+}
 
-        if (!inputPointer) {
-            LOG_ERROR(logType, "can't decode CLUT-4 texture base pointer!");
-            return false;
-        }
+static inline __m128i __expand4(__m128i v) {
+    return _mm_or_si128(_mm_slli_epi16(v, 4), v);
+}
+#endif
 
-        void *outputPointer = buffer[level];
+void __convertColors16(const uint16_t *in, uint32_t *out, int count, uint32_t clutMode) {
+    int i = 0;
+#if defined(SIMD_SSE2)
+    const __m128i mask4 = _mm_set1_epi16(0xF), mask5 = _mm_set1_epi16(0x1F), mask6 = _mm_set1_epi16(0x3F);
+    for (; i + 8 <= count; i += 8) {
+        __m128i c = _mm_loadu_si128((const __m128i *) (in + i));
+        __m128i r, g, b, a;
 
-        switch (info.clutMode) {
+        switch (clutMode) {
         case CMODE_FORMAT_16BIT_BGR5650:
+            r = __expand5(_mm_and_si128(c, mask5));
+            g = __expand6(_mm_and_si128(_mm_srli_epi16(c, 5), mask6));
+            b = __expand5(_mm_srli_epi16(c, 11));
+            a = _mm_set1_epi16(0xFF);
+            break;
         case CMODE_FORMAT_16BIT_ABGR5551:
-        case CMODE_FORMAT_16BIT_ABGR4444:
-        {
-            data.textureByteAlignment = 2;
-            uint8_t *ip;
-            uint16_t *cp;
-            uint16_t *op = (uint16_t *) outputPointer;
-
-            cp = (uint16_t *) Core::Memory::getPointerUnchecked(info.clutAddress);
-            if (!cp) {
-                LOG_ERROR(logType, "can't decode CLUT-4 clut palette!");
-                return false;
-            }
-
-            if (info.textureSwizzle) {
-                __unswizzleTexture<4>(info, (void *) swizzledBuffer[level], (void *) inputPointer, level);
-                ip = swizzledBuffer[level];
-                inputPointer = swizzledBuffer[level];
-            } else {
-                ip = (uint8_t *) inputPointer;
-            }
-
-            int length = info.textureBufferWidth[level] * info.textureHeight[level];
-
-            uint32_t pal = info.clutCsa + (info.clutShared ? 0 : level);
-
-            for (int i = 0; i < length; i += 2) {
-                uint8_t index = *ip++;
-                *op++ = cp[getCLUTIndex((index >> 0) & 0xF, pal, info.clutSft, info.clutMsk)];
-                *op++ = cp[getCLUTIndex((index >> 4) & 0xF, pal, info.clutSft, info.clutMsk)];
-            }
+            r = __expand5(_mm_and_si128(c, mask5));
+            g = __expand5(_mm_and_si128(_mm_srli_epi16(c, 5), mask5));
+            b = __expand5(_mm_and_si128(_mm_srli_epi16(c, 10), mask5));
+            a = _mm_srli_epi16(_mm_srai_epi16(c, 15), 8);
+            break;
+        default:
+            r = __expand4(_mm_and_si128(c, mask4));
+            g = __expand4(_mm_and_si128(_mm_srli_epi16(c, 4), mask4));
+            b = __expand4(_mm_and_si128(_mm_srli_epi16(c, 8), mask4));
+            a = __expand4(_mm_srli_epi16(c, 12));
             break;
         }
-        case CMODE_FORMAT_32BIT_ABGR8888:
-        {
-            data.textureByteAlignment = 4;
-            uint8_t *ip;
-            uint32_t *cp;
-            uint32_t *op = (uint32_t *) outputPointer;
-
-            cp = (uint32_t *) Core::Memory::getPointerUnchecked(info.clutAddress);
-            if (!cp) {
-                LOG_ERROR(logType, "can't get CLUT-4 clut palette!");
-                return false;
-            }
 
-            if (info.textureSwizzle) {
-                __unswizzleTexture<4>(info, (void *) swizzledBuffer[level], (void *) inputPointer, level);
-                ip = swizzledBuffer[level];
-                inputPointer = swizzledBuffer[level];
-            } else {
-                ip = (uint8_t *) inputPointer;
-            }
+        __m128i rg = _mm_or_si128(_mm_and_si128(r, _mm_set1_epi16(0xFF)), _mm_slli_epi16(g, 8));
+        __m128i ba = _mm_or_si128(_mm_and_si128(b, _mm_set1_epi16(0xFF)), _mm_slli_epi16(a, 8));
+        _mm_storeu_si128((__m128i *) (out + i), _mm_unpacklo_epi16(rg, ba));
+        _mm_storeu_si128((__m128i *) (out + i + 4), _mm_unpackhi_epi16(rg, ba));
+    }
+#endif
+    for (; i < count; i++)
+        out[i] = __convertCLUTColor(in[i], clutMode);
+}
 
-            int length = info.textureBufferWidth[level] * info.textureHeight[level];
+static bool __buildCLUTLookup(const GPUState::TextureInfo& info, uint32_t pal, CLUTLookup& lookup) {
+    uint32_t base = getCLUTIndex(0, pal, 0, 0);
+
+    void *cp = Core::Memory::getPointerUnchecked(info.clutAddress);
+    if (!cp)
+        return false;
+
+    // csa is or'ed into the index, so the entries are only contiguous when it's zero
+    if (info.clutMode == CMODE_FORMAT_32BIT_ABGR8888) {
+        for (uint32_t i = 0; i < 256; i++)
+            lookup.clut[i] = ((const uint32_t *) cp)[i | base];
+    } else if (base == 0) {
+        __convertColors16((const uint16_t *) cp, lookup.clut, 256, info.clutMode);
+    } else {
+        uint16_t entries[256];
+        for (uint32_t i = 0; i < 256; i++)
+            entries[i] = ((const uint16_t *) cp)[i | base];
+        __convertColors16(entries, lookup.clut, 256, info.clutMode);
+    }
 
-            uint32_t pal = info.clutCsa + (info.clutShared ? 0 : level);
+    lookup.sft = info.clutSft;
+    lookup.msk = info.clutMsk;
 
-            for (int i = 0; i < length; i += 2) {
-                uint8_t index = *ip++;
-                *op++ = cp[getCLUTIndex((index >> 0) & 0xF, pal, info.clutSft, info.clutMsk)];
-                *op++ = cp[getCLUTIndex((index >> 4) & 0xF, pal, info.clutSft, info.clutMsk)];
-            }
-            break;
-        }
-        }
-    }
+    for (uint32_t i = 0; i < 256; i++)
+        lookup.table[i] = lookup.clut[(i >> lookup.sft) & lookup.msk];
+
+    for (int i = 0; i < 16; i++)
+        for (int plane = 0; plane < 4; plane++)
+            lookup.planes[plane][i] = uint8_t(lookup.table[i] >> (plane * 8));
     return true;
 }
 
-static bool decodeCLUT8(TextureData& data, const GPUState::TextureInfo& info) {
-    for (int level = 0; level < info.textureNumMipMaps; level++) {
-        if (info.clutAddress == 0) {
-            return false;
-        }
+struct CLUTCacheEntry {
+    CLUTLookup lookup;
+    uint64_t writeStamp;
+};
+
+// converted palettes are shared by every texture using the same clut layout,
+// an entry stays valid until a page holding its entries is written again. decodes
+// keep pointers to the entries, so the cache is only trimmed at the end of a frame
+static std::unordered_map<uint64_t, CLUTCacheEntry> clutCache;
+static constexpr size_t maxCLUTCacheEntries = 512;
+
+static const CLUTLookup *__getCLUTLookup(const GPUState::TextureInfo& info, uint32_t pal) {
+    uint32_t entrySize = info.clutMode == CMODE_FORMAT_32BIT_ABGR8888 ? 4 : 2;
+    uint32_t size = ((pal << 4) + 256) * entrySize;
+
+    uint64_t key = Core::Utility::hashCombine(info.clutAddress, info.clutMode);
+    key = Core::Utility::hashCombine(key, (uint64_t(info.clutSft) << 8) | info.clutMsk);
+    key = Core::Utility::hashCombine(key, pal);
+
+    auto it = clutCache.find(key);
+    if (it != clutCache.end()) {
+        if (!Core::Memory::isWrittenSince(info.clutAddress, size, it->second.writeStamp))
+            return &it->second.lookup;
+    }
 
-        void *inputPointer = Core::Memory::getPointerUnchecked(info.textureBasePointer[level]);
+    CLUTCacheEntry& entry = clutCache[key];
+    entry.writeStamp = Core::Memory::takeWriteStamp();
+    if (!__buildCLUTLookup(info, pal, entry.lookup)) {
+        clutCache.erase(key);
+        return nullptr;
+    }
+    return &entry.lookup;
+}
 
-        if (!inputPointer) {
-            LOG_ERROR(logType, "can't get CLUT-8 texture base pointer!");
-            return false;
-        }
+void __loadCLUT(const GPUState *state) {
+    const GPUState::TextureInfo& info = state->textureInfo;
+    if (info.clutAddress == 0 || !info.clutNp)
+        return;
 
-        void *outputPointer = buffer[level];
+    if (!__getCLUTLookup(info, info.clutCsa))
+        LOG_WARN(logType, "can't load clut palette at 0x%08x", info.clutAddress);
+}
 
-        switch (info.clutMode) {
-        case CMODE_FORMAT_16BIT_BGR5650:
-        case CMODE_FORMAT_16BIT_ABGR5551:
-        case CMODE_FORMAT_16BIT_ABGR4444:
-        {
-            data.textureByteAlignment = 2;
-            uint8_t *ip;
-            uint16_t *cp;
-            uint16_t *op = (uint16_t *) outputPointer;
-
-            cp = (uint16_t *) Core::Memory::getPointerUnchecked(info.clutAddress);
-            if (!cp) {
-                LOG_ERROR(logType, "can't get CLUT-8 clut palette!");
-                return false;
-            }
+void __clearCLUTCache() {
+    clutCache.clear();
+}
 
-            if (info.textureSwizzle) {
-                __unswizzleTexture<8>(info, (void *) swizzledBuffer[level], (void *) inputPointer, level);
-                ip = swizzledBuffer[level];
-                inputPointer = swizzledBuffer[level];
-            } else {
-                ip = (uint8_t *) inputPointer;
-            }
+#if defined(SIMD_SSSE3)
+// looks up 16 CLUT4 indices at once, one pshufb per output byte plane
+static inline void __lookupCLUT4x16(__m128i index, const CLUTLookup& lookup, uint32_t *out) {
+    __m128i b0 = _mm_shuffle_epi8(_mm_load_si128((const __m128i *) lookup.planes[0]), index);
+    __m128i b1 = _mm_shuffle_epi8(_mm_load_si128((const __m128i *) lookup.planes[1]), index);
+    __m128i b2 = _mm_shuffle_epi8(_mm_load_si128((const __m128i *) lookup.planes[2]), index);
+    __m128i b3 = _mm_shuffle_epi8(_mm_load_si128((const __m128i *) lookup.planes[3]), index);
+
+    __m128i lo01 = _mm_unpacklo_epi8(b0, b1), lo23 = _mm_unpacklo_epi8(b2, b3);
+    __m128i hi01 = _mm_unpackhi_epi8(b0, b1), hi23 = _mm_unpackhi_epi8(b2, b3);
+    _mm_storeu_si128((__m128i *) (out + 0), _mm_unpacklo_epi16(lo01, lo23));
+    _mm_storeu_si128((__m128i *) (out + 4), _mm_unpackhi_epi16(lo01, lo23));
+    _mm_storeu_si128((__m128i *) (out + 8), _mm_unpacklo_epi16(hi01, hi23));
+    _mm_storeu_si128((__m128i *) (out + 12), _mm_unpackhi_epi16(hi01, hi23));
+}
+#endif
 
-            int length = info.textureBufferWidth[level] * info.textureHeight[level];
+// decodes one 16 byte chunk of indices, which is also one row of a swizzle block
+template<int _Bpp>
+static inline void __decodeCLUTChunk(const uint8_t *in, uint32_t *out, const CLUTLookup& lookup) {
+    if constexpr (_Bpp == 4) {
+#if defined(SIMD_SSSE3)
+        __m128i v = _mm_loadu_si128((const __m128i *) in);
+        __m128i lo = _mm_and_si128(v, _mm_set1_epi8(0xF));
+        __m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), _mm_set1_epi8(0xF));
+        __lookupCLUT4x16(_mm_unpacklo_epi8(lo, hi), lookup, out);
+        __lookupCLUT4x16(_mm_unpackhi_epi8(lo, hi), lookup, out + 16);
+#else
+        for (int i = 0; i < 16; i++) {
+            out[i * 2 + 0] = lookup.table[in[i] & 0xF];
+            out[i * 2 + 1] = lookup.table[in[i] >> 4];
+        }
+#endif
+    } else if constexpr (_Bpp == 8) {
+#if defined(SIMD_AVX2)
+        __m128i v = _mm_loadu_si128((const __m128i *) in);
+        _mm256_storeu_si256((__m256i *) (out + 0), _mm256_i32gather_epi32((const int *) lookup.table, _mm256_cvtepu8_epi32(v), 4));
+        _mm256_storeu_si256((__m256i *) (out + 8), _mm256_i32gather_epi32((const int *) lookup.table, _mm256_cvtepu8_epi32(_mm_srli_si128(v, 8)), 4));
+#else
+        for (int i = 0; i < 16; i++)
+            out[i] = lookup.table[in[i]];
+#endif
+    } else if constexpr (_Bpp == 16) {
+#if defined(SIMD_AVX2)
+        __m128i v = _mm_loadu_si128((const __m128i *) in);
+        v = _mm_and_si128(_mm_srl_epi16(v, _mm_cvtsi32_si128(lookup.sft)), _mm_set1_epi16((short) lookup.msk));
+        _mm256_storeu_si256((__m256i *) out, _mm256_i32gather_epi32((const int *) lookup.clut, _mm256_cvtepu16_epi32(v), 4));
+#else
+        const uint16_t *ip = (const uint16_t *) in;
+        for (int i = 0; i < 8; i++)
+            out[i] = lookup.clut[(ip[i] >> lookup.sft) & lookup.msk];
+#endif
+    } else {
+#if defined(SIMD_AVX2)
+        __m128i v = _mm_loadu_si128((const __m128i *) in);
+        v = _mm_and_si128(_mm_srl_epi32(v, _mm_cvtsi32_si128(lookup.sft)), _mm_set1_epi32(lookup.msk));
+        _mm_storeu_si128((__m128i *) out, _mm_i32gather_epi32((const int *) lookup.clut, v, 4));
+#else
+        const uint32_t *ip = (const uint32_t *) in;
+        for (int i = 0; i < 4; i++)
+            out[i] = lookup.clut[(ip[i] >> lookup.sft) & lookup.msk];
+#endif
+    }
+}
 
-            uint32_t pal = info.clutCsa + (info.clutShared ? 0 : level);
+template<int _Bpp>
+static inline uint32_t __readCLUTIndex(const uint8_t *in, int i) {
+    switch (_Bpp) {
+    case  4: return (in[i >> 1] >> ((i & 1) * 4)) & 0xF;
+    case  8: return in[i];
+    case 16: return ((const uint16_t *) in)[i];
+    default: return ((const uint32_t *) in)[i];
+    }
+}
 
-            for (int i = 0; i < length; i++) {
-                uint8_t index = *ip++;
-                *op++ = cp[getCLUTIndex(index, pal, info.clutSft, info.clutMsk)];
+// unswizzling is fused with the lookup, the swizzled source is walked in order one
+// 16 byte block row at a time and every row is decoded straight to its final place
+template<int _Bpp>
+static void __decodeCLUTRows(const GPUState::TextureInfo& info, const TextureLevel& level, int rowStart, int rowEnd) {
+    constexpr int pixelsPerChunk = 128 / _Bpp;
+    const CLUTLookup& lookup = *level.lookup;
+    const uint8_t *inputPointer = level.input;
+    uint32_t *op = (uint32_t *) level.output;
+    int bufferWidth = info.textureBufferWidth[level.level];
+
+    if (info.textureSwizzle) {
+        int widthBlocks = (bufferWidth * _Bpp / 8) / 16;
+        inputPointer += size_t(rowStart / 8) * widthBlocks * 128;
+
+        for (int blocky = rowStart / 8; blocky < rowEnd / 8; blocky++) {
+            for (int blockx = 0; blockx < widthBlocks; blockx++) {
+                uint32_t *dst = op + blocky * 8 * bufferWidth + blockx * pixelsPerChunk;
+                for (int j = 0; j < 8; j++) {
+                    __decodeCLUTChunk<_Bpp>(inputPointer, dst, lookup);
+                    inputPointer += 16;
+                    dst += bufferWidth;
+                }
             }
-            break;
         }
-        case CMODE_FORMAT_32BIT_ABGR8888:
-        {
-            data.textureByteAlignment = 4;
-            uint8_t *ip;
-            uint32_t *cp;
-            uint32_t *op = (uint32_t *) outputPointer;
-
-            cp = (uint32_t *) Core::Memory::getPointerUnchecked(info.clutAddress);
-            if (!cp) {
-                LOG_ERROR(logType, "can't get CLUT-8 clut palette!");
-                return false;
-            }
+    } else {
+        int i = rowStart * bufferWidth;
+        int length = rowEnd * bufferWidth;
+        for (; i + pixelsPerChunk <= length; i += pixelsPerChunk)
+            __decodeCLUTChunk<_Bpp>(inputPointer + i * _Bpp / 8, op + i, lookup);
 
-            if (info.textureSwizzle) {
-                __unswizzleTexture<8>(info, (void *) swizzledBuffer[level], (void *) inputPointer, level);
-                ip = swizzledBuffer[level];
-                inputPointer = swizzledBuffer[level];
-            } else {
-                ip = (uint8_t *) inputPointer;
-            }
+        for (; i < length; i++)
+            op[i] = lookup.clut[(__readCLUTIndex<_Bpp>(inputPointer, i) >> lookup.sft) & lookup.msk];
+    }
+}
 
-            int length = info.textureBufferWidth[level] * info.textureHeight[level];
+static bool compressedTextureSupport;
 
-            uint32_t pal = info.clutCsa + (info.clutShared ? 0 : level);
+void setCompressedTextureSupport(bool supported) {
+    compressedTextureSupport = supported;
+}
 
-            for (int i = 0; i < length; i++) {
-                uint8_t index = *ip++;
-                *op++ = cp[getCLUTIndex(index, pal, info.clutSft, info.clutMsk)];
-            }
-            break;
-        }
-        }
+// rows are decoded in whole blocks, bands always start on a block row
+template<int _Format>
+static void __decodeDXTRows(const GPUState::TextureInfo& info, const TextureLevel& level, bool compressed, int rowStart, int rowEnd) {
+    constexpr int blockSize = _Format == GE_TFMT_DXT1 ? 8 : 16;
+    int bufferWidth = info.textureBufferWidth[level.level];
+    int width = info.textureWidth[level.level];
+    int blocksPerRow = std::max(bufferWidth / 4, 1);
+
+    if (compressed) {
+        int blocksWide = (width + 3) / 4;
+        for (int blocky = rowStart / 4; blocky < (rowEnd + 3) / 4; blocky++)
+            for (int blockx = 0; blockx < blocksWide; blockx++)
+                __convertDXTBlock<_Format>(level.input + (blocky * blocksPerRow + std::min(blockx, blocksPerRow - 1)) * blockSize,
+                    level.output + (blocky * blocksWide + blockx) * blockSize);
+        return;
+    }
+
+    int blocksWide = (std::min(bufferWidth, width) + 3) / 4;
+    for (int blocky = rowStart / 4; blocky < (rowEnd + 3) / 4; blocky++)
+        for (int blockx = 0; blockx < blocksWide; blockx++)
+            __decodeDXTBlock<_Format>(level.input + (blocky * blocksPerRow + blockx) * blockSize,
+                (uint32_t *) level.output + (blocky * 4) * bufferWidth + blockx * 4, bufferWidth);
+}
+
+template<int _Bpp>
+static void __decodeDirectRows(const GPUState::TextureInfo& info, const TextureLevel& level, int rowStart, int rowEnd) {
+    size_t rowBytes = size_t(info.textureBufferWidth[level.level]) * _Bpp / 8;
+    const uint8_t *inputPointer = level.input + rowStart * rowBytes;
+    uint8_t *outputPointer = level.output + rowStart * rowBytes;
+
+    if (info.textureSwizzle)
+        __fastUnswizzle(outputPointer, inputPointer, (int32_t) rowBytes, rowEnd - rowStart);
+    else
+        std::memcpy(outputPointer, inputPointer, (rowEnd - rowStart) * rowBytes);
+}
+
+// decoded levels live in the frame arena, rows keep the buffer width stride
+static size_t __getDecodedLevelSize(const TextureData& data, const GPUState::TextureInfo& info, int level) {
+    size_t width = std::max(info.textureBufferWidth[level], info.textureWidth[level]);
+    size_t height = info.textureHeight[level];
+
+    switch (info.textureStorage) {
+    case GE_TFMT_5650:
+    case GE_TFMT_5551:
+    case GE_TFMT_4444:
+        return width * height * 2;
+    case GE_TFMT_DXT1:
+    case GE_TFMT_DXT3:
+    case GE_TFMT_DXT5:
+        if (data.compressedFormat)
+            return size_t((info.textureWidth[level] + 3) / 4) * ((height + 3) / 4) * (info.textureStorage == GE_TFMT_DXT1 ? 8 : 16);
+        // whole blocks are written, the last one of a level may spill 3 texels past the last row
+        return (width * ((height + 3) & ~3) + 4) * 4;
+    default:
+        return width * height * 4;
     }
-    return true;
 }
 
-static bool decodeCLUT16(TextureData& data, const GPUState::TextureInfo& info) {
-    for (int level = 0; level < info.textureNumMipMaps; level++) {
+// memory, input pointers and palettes are resolved on the emulation thread,
+// afterwards the rows of every level can be decoded in bands on any thread
+static bool __prepareTextureDecode(TextureDecodeJob& job, const GPUState::TextureInfo& info, bool copyPalettes) {
+    static const uint32_t compressedFormat[3] = {
+        GL_COMPRESSED_RGBA_S3TC_DXT1_EXT,
+        GL_COMPRESSED_RGBA_S3TC_DXT3_EXT,
+        GL_COMPRESSED_RGBA_S3TC_DXT5_EXT,
+    };
+
+    TextureData& data = job.data;
+    job.info = info;
+    data.writeStamp = Core::Memory::takeWriteStamp();
+
+    switch (info.textureStorage) {
+    case GE_TFMT_5650:
+    case GE_TFMT_5551:
+    case GE_TFMT_4444:
+        data.textureByteAlignment = 2;
+        break;
+    case GE_TFMT_8888:
+        data.textureByteAlignment = 4;
+        break;
+    case GE_TFMT_CLUT4:
+    case GE_TFMT_CLUT8:
+    case GE_TFMT_CLUT16:
+    case GE_TFMT_CLUT32:
+        data.textureByteAlignment = 4;
         if (info.clutAddress == 0) {
+            LOG_ERROR(logType, "can't decode CLUT texture without a clut address");
             return false;
         }
 
-        void *inputPointer = Core::Memory::getPointerUnchecked(info.textureBasePointer[level]);
+        if (copyPalettes)
+            job.palettes = std::make_unique<CLUTLookup[]>(info.textureNumMipMaps);
+        break;
+    case GE_TFMT_DXT1:
+    case GE_TFMT_DXT3:
+    case GE_TFMT_DXT5:
+        data.textureByteAlignment = 4;
+        data.compressedFormat = compressedTextureSupport ? compressedFormat[info.textureStorage - GE_TFMT_DXT1] : 0;
+        break;
+    default:
+        LOG_ERROR(logType, "Unimplemented texture storage 0x%02x!", info.textureStorage);
+        data.textureByteAlignment = 0;
+        return false;
+    }
 
-        if (!inputPointer) {
-            LOG_ERROR(logType, "can't get CLUT-16 texture base pointer!");
+    for (int i = 0; i < info.textureNumMipMaps; i++) {
+        TextureLevel& level = job.levels[i];
+        level.level = i;
+        level.input = (const uint8_t *) Core::Memory::getPointerUnchecked(info.textureBasePointer[i]);
+        if (!level.input) {
+            LOG_ERROR(logType, "can't get texture base pointer of level %d (storage 0x%02x)!", i, info.textureStorage);
             return false;
         }
 
-        void *outputPointer = buffer[level];
-
-        switch (info.clutMode) {
-        case CMODE_FORMAT_16BIT_BGR5650:
-        case CMODE_FORMAT_16BIT_ABGR5551:
-        case CMODE_FORMAT_16BIT_ABGR4444:
-        {
-            data.textureByteAlignment = 2;
-            uint16_t *ip;
-            uint16_t *cp;
-            uint16_t *op = (uint16_t *) outputPointer;
-
-            cp = (uint16_t *) Core::Memory::getPointerUnchecked(info.clutAddress);
-            if (!cp) {
-                LOG_ERROR(logType, "can't get CLUT-16 clut palette!");
+        if (isIndexedTexture(&info)) {
+            level.lookup = __getCLUTLookup(info, info.clutCsa + (info.clutShared ? 0 : i));
+            if (!level.lookup) {
+                LOG_ERROR(logType, "can't get clut palette of level %d!", i);
                 return false;
             }
 
-            if (info.textureSwizzle) {
-                __unswizzleTexture<16>(info, (void *) swizzledBuffer[level], (void *) inputPointer, level);
-                ip = (uint16_t *) swizzledBuffer[level];
-                inputPointer = swizzledBuffer[level];
-            } else {
-                ip = (uint16_t *) inputPointer;
+            if (job.palettes) {
+                job.palettes[i] = *level.lookup;
+                level.lookup = &job.palettes[i];
             }
+        }
 
-            int length = info.textureBufferWidth[level] * info.textureHeight[level];
+        size_t size = __getDecodedLevelSize(data, info, i);
+        level.output = data.decodedLevel[i] = (uint8_t *) Core::Utility::getFrameArena().allocate(size);
+        if (data.compressedFormat)
+            data.compressedLevelSize[i] = (uint32_t) size;
+    }
+    return true;
+}
 
-            uint32_t pal = info.clutCsa + (info.clutShared ? 0 : level);
+static void __decodeTextureRows(const TextureDecodeJob& job, int level, int rowStart, int rowEnd) {
+    const GPUState::TextureInfo& info = job.info;
+    const TextureLevel& _level = job.levels[level];
+    bool compressed = job.data.compressedFormat != 0;
 
-            for (int i = 0; i < length; i++) {
-                uint16_t index = *ip++;
-                *op++ = cp[getCLUTIndex(index, pal, info.clutSft, info.clutMsk)];
-            }
-            break;
-        }
-        case CMODE_FORMAT_32BIT_ABGR8888:
-        {
-            data.textureByteAlignment = 4;
-            uint16_t *ip;
-            uint32_t *cp;
-            uint32_t *op = (uint32_t *) outputPointer;
-
-            cp = (uint32_t *) Core::Memory::getPointerUnchecked(info.clutAddress);
-            if (!cp) {
-                LOG_ERROR(logType, "can't get CLUT-16 clut palette!");
-                return false;
-            }
+    switch (info.textureStorage) {
+    case GE_TFMT_5650:
+    case GE_TFMT_5551:
+    case GE_TFMT_4444: __decodeDirectRows<16>(info, _level, rowStart, rowEnd); break;
+    case GE_TFMT_8888: __decodeDirectRows<32>(info, _level, rowStart, rowEnd); break;
+    case GE_TFMT_CLUT4: __decodeCLUTRows<4>(info, _level, rowStart, rowEnd); break;
+    case GE_TFMT_CLUT8: __decodeCLUTRows<8>(info, _level, rowStart, rowEnd); break;
+    case GE_TFMT_CLUT16: __decodeCLUTRows<16>(info, _level, rowStart, rowEnd); break;
+    case GE_TFMT_CLUT32: __decodeCLUTRows<32>(info, _level, rowStart, rowEnd); break;
+    case GE_TFMT_DXT1: __decodeDXTRows<GE_TFMT_DXT1>(info, _level, compressed, rowStart, rowEnd); break;
+    case GE_TFMT_DXT3: __decodeDXTRows<GE_TFMT_DXT3>(info, _level, compressed, rowStart, rowEnd); break;
+    case GE_TFMT_DXT5: __decodeDXTRows<GE_TFMT_DXT5>(info, _level, compressed, rowStart, rowEnd); break;
+    }
+}
 
-            if (info.textureSwizzle) {
-                __unswizzleTexture<16>(info, (void *) swizzledBuffer[level], (void *) inputPointer, level);
-                ip = (uint16_t *) swizzledBuffer[level];
-                inputPointer = swizzledBuffer[level];
-            } else {
-                ip = (uint16_t *) inputPointer;
-            }
+static constexpr int textureBandRows = 64;
+static constexpr size_t parallelDecodeTexels = 128 * 128;
 
-            int length = info.textureBufferWidth[level] * info.textureHeight[level];
+// every level is split into bands of rows (a multiple of the 8 row swizzle block and the
+// 4 row DXT block), large textures fan the bands of all levels out to the thread pool
+static void __runTextureDecode(const TextureDecodeJob& job, bool parallel) {
+    struct Band {
+        int level, rowStart, rowEnd;
+    };
 
-            uint32_t pal = info.clutCsa + (info.clutShared ? 0 : level);
+    std::vector<Band> bands;
+    size_t texels = 0;
 
-            for (int i = 0; i < length; i++) {
-                uint16_t index = *ip++;
-                *op++ = cp[getCLUTIndex(index, pal, info.clutSft, info.clutMsk)];
-            }
-            break;
-        }
-        }
+    for (int i = 0; i < job.info.textureNumMipMaps; i++) {
+        int height = job.info.textureHeight[i];
+        texels += size_t(job.info.textureBufferWidth[i]) * height;
+        for (int row = 0; row < height; row += textureBandRows)
+            bands.push_back(Band { .level = i, .rowStart = row, .rowEnd = std::min(row + textureBandRows, height) });
     }
-    return true;
+
+    if (parallel && texels >= parallelDecodeTexels) {
+        Core::Utility::getThreadPool().parallelFor((int) bands.size(), [&](int i) {
+            __decodeTextureRows(job, bands[i].level, bands[i].rowStart, bands[i].rowEnd);
+        });
+        return;
+    }
+
+    for (auto& i : bands)
+        __decodeTextureRows(job, i.level, i.rowStart, i.rowEnd);
 }
 
-static bool decodeCLUT32(TextureData& data, const GPUState::TextureInfo& info) {
-    for (int level = 0; level < info.textureNumMipMaps; level++) {
-        if (info.clutAddress == 0) {
-            return false;
-        }
+static TextureData __finishTextureDecode(TextureDecodeJob& job, uint64_t key) {
+    TextureData& data = job.data;
+    data.key = key;
+    data.timestamp = Core::Timing::getSystemTimeMilliseconds();
+    data.handle = 0;
+    data.textureInfo = job.info;
+    data.isDirty = false;
+    data.forceUpdate = true;
+    return data;
+}
 
-        void *inputPointer = Core::Memory::getPointerUnchecked(info.textureBasePointer[level]);
+TextureData __decodeTexture(const GPUState *state, uint64_t key) {
+    TextureDecodeJob job {};
 
-        if (!inputPointer) {
-            LOG_ERROR(logType, "can't get CLUT-32 texture base pointer!");
-            return false;
+    if (!state->textureEnable || state->clearModeEnable) {
+        job.data.isDirty = true;
+        return job.data;
+    }
+
+    if (!__prepareTextureDecode(job, state->textureInfo, false)) {
+        job.data.isDirty = true;
+        return job.data;
+    }
+
+    __runTextureDecode(job, true);
+    return __finishTextureDecode(job, key);
+}
+
+struct PendingTexture {
+    TextureDecodeJob job;
+    std::future<void> done;
+    bool taken;
+};
+
+static std::unordered_map<uint64_t, std::unique_ptr<PendingTexture>> pendingTextures;
+static std::vector<uint64_t> boundTextures; // keys bound during the current frame
+static uint64_t textureFrame = 1;
+static constexpr auto pendingTextureBudget = std::chrono::microseconds(2000);
+static constexpr int maxPrefetchedTextures = 32;
+
+// a speculative decode is used when it finished within the budget and nothing was
+// written since it started, otherwise the texture is decoded again right away
+static TextureData __decodeBoundTexture(const GPUState *state, uint64_t key) {
+    ProfilerScope scope(PROFILER_STAGE_DECODE);
+    auto it = pendingTextures.find(key);
+    if (it != pendingTextures.end() && !it->second->taken) {
+        PendingTexture& pending = *it->second;
+        pending.taken = true;
+
+        if (pending.done.wait_for(pendingTextureBudget) == std::future_status::ready &&
+            !memcmp(&pending.job.info, &state->textureInfo, sizeof pending.job.info)) {
+            TextureData data = __finishTextureDecode(pending.job, key);
+            if (!isTextureWritten(&data))
+                return data;
         }
+    }
+    return __decodeTexture(state, key);
+}
 
-        void *outputPointer = buffer[level];
+// textures bound during the frame which were written afterwards are decoded again on the
+// pool, the jobs only hold the frame arena so they are all waited for before it's reset
+void __prefetchTextures() {
+    int count = 0;
+    for (uint64_t key : boundTextures) {
+        auto it = textureDataCache.find(key);
+        if (it == textureDataCache.end() || !isTextureWritten(&it->second))
+            continue;
 
-        switch (info.clutMode) {
-        case CMODE_FORMAT_16BIT_BGR5650:
-        case CMODE_FORMAT_16BIT_ABGR5551:
-        case CMODE_FORMAT_16BIT_ABGR4444:
-        {
-            data.textureByteAlignment = 2;
-            uint32_t *ip;
-            uint16_t *cp;
-            uint16_t *op = (uint16_t *) outputPointer;
-
-            cp = (uint16_t *) Core::Memory::getPointerUnchecked(info.clutAddress);
-            if (!cp) {
-                LOG_ERROR(logType, "can't get CLUT-32 clut palette!");
-                return false;
-            }
+        if (count++ == maxPrefetchedTextures)
+            break;
 
-            if (info.textureSwizzle) {
-                __unswizzleTexture<32>(info, (void *) swizzledBuffer[level], (void *) inputPointer, level);
-                ip = (uint32_t *) swizzledBuffer[level];
-                inputPointer = swizzledBuffer[level];
-            } else {
-                ip = (uint32_t *) inputPointer;
-            }
+        auto pending = std::make_unique<PendingTexture>();
+        if (!__prepareTextureDecode(pending->job, it->second.textureInfo, true))
+            continue;
 
-            int length = info.textureBufferWidth[level] * info.textureHeight[level];
+        PendingTexture *_pending = pending.get();
+        pending->done = Core::Utility::getThreadPool().submit([_pending] { __runTextureDecode(_pending->job, false); });
+        pendingTextures[key] = std::move(pending);
+    }
 
-            uint32_t pal = info.clutCsa + (info.clutShared ? 0 : level);
+    boundTextures.clear();
+    textureFrame++;
+}
 
-            for (int i = 0; i < length; i++) {
-                uint32_t index = *ip++;
-                *op++ = cp[getCLUTIndex(index, pal, info.clutSft, info.clutMsk)];
-            }
-            break;
-        }
-        case CMODE_FORMAT_32BIT_ABGR8888:
-        {
-            data.textureByteAlignment = 4;
-            uint32_t *ip;
-            uint32_t *cp;
-            uint32_t *op = (uint32_t *) outputPointer;
-
-            cp = (uint32_t *) Core::Memory::getPointerUnchecked(info.clutAddress);
-            if (!cp) {
-                LOG_ERROR(logType, "can't get CLUT-32 clut palette!");
-                return false;
-            }
+static void __waitPendingTextures() {
+    for (auto& i : pendingTextures)
+        i.second->done.wait();
+    pendingTextures.clear();
+}
 
-            if (info.textureSwizzle) {
-                __unswizzleTexture<32>(info, (void *) swizzledBuffer[level], (void *) inputPointer, level);
-                ip = (uint32_t *) swizzledBuffer[level];
-                inputPointer = swizzledBuffer[level];
-            } else {
-                ip = (uint32_t *) inputPointer;
-            }
+// textures are evicted from the least recently used end until the cache fits its budget again,
+// the cost only depends on how many textures get evicted
+std::vector<TextureCacheData> __updateTextureCache(bool uploadsTextures) {
+    std::vector<TextureCacheData> data;
 
-            int length = info.textureBufferWidth[level] * info.textureHeight[level];
+    __waitPendingTextures();
+    if (clutCache.size() >= maxCLUTCacheEntries)
+        clutCache.clear();
 
-            uint32_t pal = info.clutCsa + (info.clutShared ? 0 : level);
+    // the decoded levels are about to be reset with the frame arena, a texture the host
+    // never uploaded (the draw was skipped) is dropped and decoded again when it's bound.
+    // without a host renderer nothing is uploaded and the levels are never looked at again
+    for (size_t i = 0; uploadsTextures && i < boundTextures.size(); i++) {
+        auto it = textureDataCache.find(boundTextures[i]);
+        if (it == textureDataCache.end() || (it->second.handle && !it->second.forceUpdate))
+            continue;
 
-            for (int i = 0; i < length; i++) {
-                uint32_t index = *ip++;
-                *op++ = cp[getCLUTIndex(index, pal, info.clutSft, info.clutMsk)];
-            }
-            break;
-        }
-        }
+        data.push_back(TextureCacheData { .handle = it->second.handle, .key = it->first });
+        eraseTexture(it);
     }
-    return true;
-}
 
-TextureData __decodeTexture(const GPUState *state, uint64_t key) {
-    TextureData data{};
+    while (textureCacheMemorySize > textureCacheBudget && !textureLRU.empty()) {
+        TextureData *_data = textureLRU.leastRecentlyUsed();
+        data.push_back(TextureCacheData { .handle = _data->handle, .key = _data->key });
+        eraseTexture(textureDataCache.find(_data->key));
+    }
+    return data;
+}
 
-    if (!state->textureEnable || state->clearModeEnable) {
-        data.isDirty = true;
-        return data;
+static TextureData *__bindTexture(TextureData *data) {
+    textureLRU.touch(data);
+    if (data->boundFrame != textureFrame) {
+        data->boundFrame = textureFrame;
+        boundTextures.push_back(data->key);
     }
+    return data;
+}
 
+TextureData *__getTextureFromCache(const GPUState *state) {
     const GPUState::TextureInfo& info = state->textureInfo;
-    switch (info.textureStorage) {
-    case GE_TFMT_5650:
-    case GE_TFMT_5551:
-    case GE_TFMT_4444:
-        data.textureByteAlignment = 2;
-        for (int level = 0; level < info.textureNumMipMaps; level++) {
-            void *inputPointer = Core::Memory::getPointerUnchecked(info.textureBasePointer[level]);
-            if (!inputPointer) {
-                LOG_ERROR(logType, "can't get GE_TMFT_4bpp texture base pointer!");
-                data.isDirty = true;
-                return data;
-            }
 
-            void *outputPointer = buffer[level];
-            if (info.textureSwizzle) {
-                __unswizzleTexture<32>(info, (void *) outputPointer, (void *) inputPointer, level);
-            } else {
-                int length = (info.textureBufferWidth[level] * info.textureHeight[level]) * sizeof(uint32_t);
-                std::memcpy(outputPointer, inputPointer, length);
-            }
-        }
-        break;
-    case GE_TFMT_8888:
-        data.textureByteAlignment = 4;
-        for (int level = 0; level < info.textureNumMipMaps; level++) {
-            void *inputPointer = Core::Memory::getPointerUnchecked(info.textureBasePointer[level]);
-            if (!inputPointer) {
-                LOG_ERROR(logType, "can't get GE_TMFT_8bpp texture base pointer!");
-                data.isDirty = true;
-                return data;
-            }
+    if (!state->textureEnable || state->clearModeEnable)
+        return nullptr;
 
-            void *outputPointer = buffer[level];
-            if (info.textureSwizzle) {
-                __unswizzleTexture<32>(info, (void *) outputPointer, (void *) inputPointer, level);
-            } else {
-                int length = (info.textureBufferWidth[level] * info.textureHeight[level]) * sizeof(uint32_t);
-                std::memcpy(outputPointer, inputPointer, length);
-            }
-        }
-        break;
-    case GE_TFMT_CLUT4:
-        if (!decodeCLUT4(data, info)) {
-            LOG_ERROR(logType, "can't decode CLUT4");
-            data.isDirty = true;
-            return data;
-        }
-        break;
-    case GE_TFMT_CLUT8:
-        if (!decodeCLUT8(data, info)) {
-            LOG_ERROR(logType, "can't decode CLUT8");
-            data.isDirty = true;
-            return data;
-        }
-        break;
-    case GE_TFMT_CLUT16:
-        if (!decodeCLUT16(data, info)) {
-            LOG_ERROR(logType, "can't decode CLUT16");
-            data.isDirty = true;
-            return data;
-        }
-        break;
-    case GE_TFMT_CLUT32:
-        if (!decodeCLUT32(data, info)) {
-            LOG_ERROR(logType, "can't decode CLUT32");
-            data.isDirty = true;
-            return data;
+    // a level the GE rendered to is written back to VRAM before it's looked at
+    for (int i = 0; i < info.textureNumMipMaps; i++)
+        Core::Memory::checkReads(info.textureBasePointer[i], getTextureLevelSize(&info, i));
+
+    uint64_t key = getTextureKey(&state->textureInfo);
+
+    TextureData data;
+
+    auto it = textureDataCache.find(key);
+    if (it != textureDataCache.end()) {
+        if (!it->second.isDirty && !memcmp(&it->second.textureInfo, &info, sizeof info) && !isTextureWritten(&it->second)) {
+            __profileTextureCache(true, 0);
+            return __bindTexture(&it->second);
         }
-        break;
 
-    case GE_TFMT_DXT1:
-    case GE_TFMT_DXT3:
-    case GE_TFMT_DXT5:
-    default:
-        data.isDirty = true;
-        LOG_ERROR(logType, "Unimplemented texture storage 0x%02x!", info.textureStorage);
-        data.textureByteAlignment = 0;
-        return data;
-    }
+        __profileTextureCache(false, getDecodedTextureSize(info));
 
-    data.key = key;
-    data.timestamp = Core::Timing::getSystemTimeMilliseconds();
-    data.handle = 0;
-    data.textureInfo = state->textureInfo;
-    data.handle = 0;
-    data.isDirty = false;
-    data.forceUpdate = true;
+        // the batch may still draw with the old entry and its handle
+        __FlushPrimitives(getGPUState());
 
-    return data;
-}
+        uint64_t oldHandle = it->second.handle;
+        it->second.isDirty = true;
+        eraseTexture(it);
+        // LOG_DEBUG(logType, "dirty 0x%016llx.texcache remaking...", key);
+
+        data = __decodeBoundTexture(state, key);
+        if (data.isDirty == true) {
+            LOG_ERROR(logType, "can't save texture again, key 0x%016llx invalid decoding", key);
+            return nullptr;
+        }
+        
+        data.handle = oldHandle;
+        data.forceUpdate = true;
+        return __bindTexture(insertTexture(key, data));
+    }
 
-void *getCurrentDecodedTexture(int level) {
-    return buffer[level];
+    __profileTextureCache(false, getDecodedTextureSize(info));
+    data = __decodeBoundTexture(state, key);
+    if (data.isDirty == true) {
+        LOG_ERROR(logType, "can't save texture, key 0x%016llx invalid decoding", key);
+        return nullptr;
+    }
+
+    LOG_DEBUG(logType, "saved 0x%016llx.texcache", key);
+    return __bindTexture(insertTexture(key, data));
 }
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include <vector>
 
 #include <Core/GPU/GPU.h>
+#include <Core/Kernel/LRU.h>
 
 namespace Core::GPU {
 struct TextureData {
@@ -11,8 +12,15 @@ struct TextureData {
     int textureByteAlignment;
     uint64_t handle; // For OpenGL
     uint64_t key;
+    uint64_t writeStamp; // memory write stamp taken when the texture was decoded
+    uint8_t *decodedLevel[8]; // frame arena memory, only valid until the end of the frame it was decoded in
+    uint32_t compressedFormat; // S3TC format when the levels hold DXT blocks for upload, 0 when decoded
+    uint32_t compressedLevelSize[8];
+    uint64_t boundFrame; // last frame the texture was bound in, those are prefetched when written
     bool isDirty;
     bool forceUpdate;
+    size_t memorySize; // decoded size of every level, counted against the cache budget
+    Core::DS::LRUNode lruNode;
     uint32_t getTexturePixelType();
 };
 
@@ -21,12 +29,22 @@ struct TextureCacheData {
     uint64_t key;
 };
 
-std::vector<TextureCacheData> __updateTextureCache(); // returns handles for host renderer destroying
+// called once per frame, returns handles for host renderer destroying. uploadsTextures is
+// false when no host renderer takes the decoded levels
+std::vector<TextureCacheData> __updateTextureCache(bool uploadsTextures);
+void setTextureCacheBudget(size_t bytes);
+size_t getTextureCacheMemorySize();
+void setCompressedTextureSupport(bool supported); // DXT textures are passed through as S3TC when set
 
 std::vector<TextureData *> getTextureDataList();
-void *getCurrentDecodedTexture(int level);
 
 TextureData *__getTextureByKey(const uint64_t& key);
 TextureData *__getTextureFromCache(const GPUState *state);
 TextureData __decodeTexture(const GPUState *state, uint64_t key = 0);
+void __prefetchTextures(); // called once per frame after the frame arenas were reset
+
+void __loadCLUT(const GPUState *state); // converts the palette once when CLOAD is issued
+void __clearCLUTCache();
+
+void __convertColors16(const uint16_t *in, uint32_t *out, int count, uint32_t format); // 5650/5551/4444 to RGBA8888
 }
\ No newline at end of file
@@ -1,68 +1,262 @@
 #include <Core/GPU/GPU.h>
 #include <Core/GPU/VertexDecoder.h>
 #include <Core/GPU/GEConstants.h>
+#include <Core/GPU/GPUProfiler.h>
 
 #include <Core/Memory/MemoryAccess.h>
 
+#include <Core/Utility/SIMD.h>
+#include <Core/Utility/Hash.h>
+
 #include <Core/Logger.h>
 
 #include <unordered_map>
+#include <algorithm>
 
 namespace Core::GPU {
 static const char *logType = "VertexDecoder";
 
+static void __getIndexRange(const void *indices, int indexType, int count, uint32_t& minIndex, uint32_t& maxIndex) {
+    int i = 0;
+    if (indexType == 1) {
+        const uint8_t *p = (const uint8_t *) indices;
+        uint8_t lo = 0xFF, hi = 0;
+#if defined(SIMD_SSE2)
+        __m128i vmin = _mm_set1_epi8((char) 0xFF), vmax = _mm_setzero_si128();
+        for (; i + 16 <= count; i += 16) {
+            __m128i v = _mm_loadu_si128((const __m128i *) (p + i));
+            vmin = _mm_min_epu8(vmin, v);
+            vmax = _mm_max_epu8(vmax, v);
+        }
+        alignas(16) uint8_t mins[16], maxs[16];
+        _mm_store_si128((__m128i *) mins, vmin);
+        _mm_store_si128((__m128i *) maxs, vmax);
+        for (int k = 0; k < 16; k++) {
+            lo = std::min(lo, mins[k]);
+            hi = std::max(hi, maxs[k]);
+        }
+#endif
+        for (; i < count; i++) {
+            lo = std::min(lo, p[i]);
+            hi = std::max(hi, p[i]);
+        }
+        minIndex = lo;
+        maxIndex = hi;
+    } else if (indexType == 3) {
+        // 32-bit indices are rare, a plain scan is enough
+        const uint32_t *p = (const uint32_t *) indices;
+        uint32_t lo = 0xFFFFFFFF, hi = 0;
+        for (; i < count; i++) {
+            lo = std::min(lo, p[i]);
+            hi = std::max(hi, p[i]);
+        }
+        minIndex = lo;
+        maxIndex = hi;
+    } else {
+        const uint16_t *p = (const uint16_t *) indices;
+        uint16_t lo = 0xFFFF, hi = 0;
+#if defined(SIMD_SSE2)
+        // SSE2 only has signed 16-bit min/max, flip the sign bit to compare unsigned
+        const __m128i bias = _mm_set1_epi16((short) 0x8000);
+        __m128i vmin = _mm_set1_epi16(0x7FFF), vmax = _mm_set1_epi16((short) 0x8000);
+        for (; i + 8 <= count; i += 8) {
+            __m128i v = _mm_xor_si128(_mm_loadu_si128((const __m128i *) (p + i)), bias);
+            vmin = _mm_min_epi16(vmin, v);
+            vmax = _mm_max_epi16(vmax, v);
+        }
+        alignas(16) uint16_t mins[8], maxs[8];
+        _mm_store_si128((__m128i *) mins, _mm_xor_si128(vmin, bias));
+        _mm_store_si128((__m128i *) maxs, _mm_xor_si128(vmax, bias));
+        for (int k = 0; k < 8; k++) {
+            lo = std::min(lo, mins[k]);
+            hi = std::max(hi, maxs[k]);
+        }
+#endif
+        for (; i < count; i++) {
+            lo = std::min(lo, p[i]);
+            hi = std::max(hi, p[i]);
+        }
+        minIndex = lo;
+        maxIndex = hi;
+    }
+}
+
+static void __rebaseIndices(const void *indices, int indexType, int count, uint32_t base, std::vector<uint8_t>& out) {
+    int i = 0;
+    if (indexType == 1) {
+        const uint8_t *p = (const uint8_t *) indices;
+        out.resize(count);
+        uint8_t *d = out.data();
+#if defined(SIMD_SSE2)
+        const __m128i vbase = _mm_set1_epi8((char) base);
+        for (; i + 16 <= count; i += 16)
+            _mm_storeu_si128((__m128i *) (d + i), _mm_sub_epi8(_mm_loadu_si128((const __m128i *) (p + i)), vbase));
+#endif
+        for (; i < count; i++)
+            d[i] = uint8_t(p[i] - base);
+    } else {
+        const uint16_t *p = (const uint16_t *) indices;
+        out.resize(count * sizeof(uint16_t));
+        uint16_t *d = (uint16_t *) out.data();
+#if defined(SIMD_SSE2)
+        const __m128i vbase = _mm_set1_epi16((short) base);
+        for (; i + 8 <= count; i += 8)
+            _mm_storeu_si128((__m128i *) (d + i), _mm_sub_epi16(_mm_loadu_si128((const __m128i *) (p + i)), vbase));
+#endif
+        for (; i < count; i++)
+            d[i] = uint16_t(p[i] - base);
+    }
+}
+
 struct VertexDataCache {
     int type;
     int count;
+    uint32_t vertexType;
+    uint32_t vertexListAddress;
     uint32_t indexListAddress;
-    std::vector<VertexData> data;
-    GPUState::VertexInfo vertexInfo;
+    uint64_t hash;
+    uint64_t lastUsedFrame;
+    DecodedVertexList data;
+
+    bool isSameDraw(const GPUState *state, int type, int count) const {
+        return this->type == type && this->count == count && vertexType == state->vertexInfo.param &&
+               vertexListAddress == state->vertexListAddress && indexListAddress == state->indexListAddress;
+    }
 
-    bool isClean(const GPUState *state, int type, int count) {
-        return this->type == type && this->count == count && state->indexListAddress == indexListAddress;
+    size_t getMemorySize() const {
+        return data.vertices.capacity() * sizeof(VertexData) + data.indices.capacity();
     }
 };
 
 static std::unordered_map<uint64_t, VertexDataCache> vertexCache;
+static size_t vertexCacheMemorySize;
+static size_t vertexCacheBudget = 32 * 1024 * 1024;
+static uint64_t vertexCacheFrame;
+
+static constexpr uint64_t VERTEX_CACHE_MAX_FRAME_AGE = 120;
 
 static uint64_t getVertexKey(const GPUState *state, int type, int count) {
+    const uint32_t draw[5] = { state->vertexListAddress, state->indexListAddress, state->vertexInfo.param, uint32_t(type), uint32_t(count) };
+    return Core::Utility::hash64(draw, sizeof draw);
+}
+
+static bool getVertexContentHash(const GPUState *state, int count, uint64_t& hash) {
     const GPUState::VertexInfo& info = state->vertexInfo;
-    uint64_t key = 0;
-    uint64_t *ptr = nullptr, *ptrEnd = nullptr;
 
-    if (state->vertexListAddress != 0) {
-        ptr = (uint64_t *) Core::Memory::getPointerUnchecked(state->vertexListAddress);
-        ptrEnd = ptr + ((count * info.vertex_size) / 8);
-    } else {
-        LOG_ERROR(logType, "can't get vertex key if vertex list is NULL");
-        return ~0uLL;
+    const uint8_t *vertices = (const uint8_t *) Core::Memory::getPointerUnchecked(state->vertexListAddress);
+    if (!vertices) {
+        LOG_ERROR(logType, "can't get vertex hash from list address 0x%08x", state->vertexListAddress);
+        return false;
     }
 
-    int vertexCount = (count * info.vertex_size);
-    for (; ptr < ptrEnd; ptr++) {
-        key += *ptr;
+    const void *indices = nullptr;
+    size_t indexSize = 0;
+    uint32_t firstVertex = 0, vertexCount = count;
+
+    if (state->indexListAddress != 0 && info.it != 0) {
+        indices = Core::Memory::getPointerUnchecked(state->indexListAddress);
+        if (!indices) {
+            LOG_ERROR(logType, "can't get vertex hash from index address 0x%08x", state->indexListAddress);
+            return false;
+        }
+
+        uint32_t minIndex = 0, maxIndex = 0;
+        if (count > 0)
+            __getIndexRange(indices, info.it, count, minIndex, maxIndex);
+
+        indexSize = size_t(count) * (info.it == 3 ? 4 : info.it);
+        firstVertex = minIndex;
+        vertexCount = maxIndex - minIndex + 1;
     }
 
-    key += type + count;
-    return key;
+    hash = Core::Utility::hash64(vertices + size_t(firstVertex) * info.vertex_size, size_t(vertexCount) * info.vertex_size);
+    if (indices)
+        hash = Core::Utility::hashCombine(hash, Core::Utility::hash64(indices, indexSize));
+
+    // morphing blends the targets on decode, the weights are part of the result
+    if (info.mc > 1)
+        hash = Core::Utility::hashCombine(hash, Core::Utility::hash64(state->morphingWeights, sizeof state->morphingWeights));
+    return true;
 }
 
-std::vector<VertexData> *__getListFromVertexCache(const GPUState *state, int type, int count) {
-    uint64_t key = 0;// getVertexKey(state, type, count);
-    VertexDataCache cache;
+const DecodedVertexList *__getListFromVertexCache(const GPUState *state, int type, int count) {
+    uint64_t key = getVertexKey(state, type, count);
+    uint64_t hash;
+
+    if (!getVertexContentHash(state, count, hash))
+        return nullptr;
 
-    if (auto it = vertexCache.find(key); it != vertexCache.end()) {
-        //return &it->second.data;
+    auto it = vertexCache.find(key);
+    if (it != vertexCache.end()) {
+        VertexDataCache& cache = it->second;
+        if (cache.isSameDraw(state, type, count) && cache.hash == hash) {
+            cache.lastUsedFrame = vertexCacheFrame;
+            __profileVertexCache(true);
+            return &cache.data;
+        }
+
+        vertexCacheMemorySize -= cache.getMemorySize();
+    } else {
+        it = vertexCache.emplace(key, VertexDataCache {}).first;
     }
 
+    __profileVertexCache(false);
+    ProfilerScope scope(PROFILER_STAGE_DECODE);
+
+    VertexDataCache& cache = it->second;
     cache.data = __decodeVertexList(state, type, count);
     cache.type = type;
     cache.count = count;
+    cache.vertexType = state->vertexInfo.param;
+    cache.vertexListAddress = state->vertexListAddress;
     cache.indexListAddress = state->indexListAddress;
-    cache.vertexInfo = state->vertexInfo;
-    vertexCache[key] = cache;
-    // LOG_DEBUG(logType, "saved 0x%016llx.vertcache", key);
-    return &vertexCache[key].data;
+    cache.hash = hash;
+    cache.lastUsedFrame = vertexCacheFrame;
+    vertexCacheMemorySize += cache.getMemorySize();
+    return &cache.data;
+}
+
+void __updateVertexCache() {
+    for (auto it = vertexCache.begin(); it != vertexCache.end(); ) {
+        if (it->second.lastUsedFrame + VERTEX_CACHE_MAX_FRAME_AGE < vertexCacheFrame) {
+            vertexCacheMemorySize -= it->second.getMemorySize();
+            it = vertexCache.erase(it);
+            continue;
+        }
+        it++;
+    }
+
+    if (vertexCacheMemorySize > vertexCacheBudget) {
+        std::vector<std::pair<uint64_t, uint64_t>> entries; // (last used frame, key)
+        entries.reserve(vertexCache.size());
+        for (auto& i : vertexCache)
+            entries.emplace_back(i.second.lastUsedFrame, i.first);
+
+        std::sort(entries.begin(), entries.end());
+        for (auto& [frame, key] : entries) {
+            if (vertexCacheMemorySize <= vertexCacheBudget || frame == vertexCacheFrame)
+                break;
+
+            auto it = vertexCache.find(key);
+            vertexCacheMemorySize -= it->second.getMemorySize();
+            vertexCache.erase(it);
+        }
+    }
+
+    vertexCacheFrame++;
+}
+
+void __clearVertexCache() {
+    vertexCache.clear();
+    vertexCacheMemorySize = 0;
+}
+
+void setVertexCacheBudget(size_t bytes) {
+    vertexCacheBudget = bytes;
+}
+
+size_t getVertexCacheMemorySize() {
+    return vertexCacheMemorySize;
 }
 
 static std::vector<VertexData> __triangulateRectangle(const std::vector<VertexData>& invertex) {
@@ -139,22 +333,330 @@ static std::vector<VertexData> __triangulateRectangle(const std::vector<VertexDa
     return outvertex;
 }
 
-std::vector<VertexData> __decodeVertexList(const GPUState *state, int type, int count) {
+#if defined(SIMD_SSE2)
+// The SIMD kernels below convert four vertices per iteration, the source attributes
+// are gathered into one lane per vertex (SoA) and written back transposed into the
+// VertexData layout. Morph targets are blended after each target is decoded, index
+// lists wider than 16 bit and morphed through mode lists take the scalar path.
+template<typename T>
+static inline T __loadAttribute(const uint8_t *p) {
+    T value;
+    std::memcpy(&value, p, sizeof value);
+    return value;
+}
+
+template<typename T>
+static inline __m128i __gatherAttribute(const uint8_t *const v[4], uint32_t offset) {
+    return _mm_setr_epi32(int32_t(__loadAttribute<T>(v[0] + offset)), int32_t(__loadAttribute<T>(v[1] + offset)),
+                          int32_t(__loadAttribute<T>(v[2] + offset)), int32_t(__loadAttribute<T>(v[3] + offset)));
+}
+
+static inline __m128 __gatherFloatAttribute(const uint8_t *const v[4], uint32_t offset) {
+    return _mm_setr_ps(__loadAttribute<float>(v[0] + offset), __loadAttribute<float>(v[1] + offset),
+                       __loadAttribute<float>(v[2] + offset), __loadAttribute<float>(v[3] + offset));
+}
+
+static inline __m128 __convertAttribute(__m128i v, float scale) {
+    return _mm_mul_ps(_mm_cvtepi32_ps(v), _mm_set1_ps(scale));
+}
+
+static inline void __storeVec2x4(VertexData *d, glm::vec2 VertexData::*field, __m128 x, __m128 y) {
+    __m128 lo = _mm_unpacklo_ps(x, y);
+    __m128 hi = _mm_unpackhi_ps(x, y);
+    _mm_storel_pi((__m64 *) &(d[0].*field)[0], lo);
+    _mm_storeh_pi((__m64 *) &(d[1].*field)[0], lo);
+    _mm_storel_pi((__m64 *) &(d[2].*field)[0], hi);
+    _mm_storeh_pi((__m64 *) &(d[3].*field)[0], hi);
+}
+
+static inline void __storeVec3x4(VertexData *d, glm::vec3 VertexData::*field, __m128 x, __m128 y, __m128 z) {
+    __m128 w = _mm_setzero_ps();
+    _MM_TRANSPOSE4_PS(x, y, z, w);
+    __m128 rows[4] = { x, y, z, w };
+    for (int i = 0; i < 4; i++) {
+        float *out = &(d[i].*field)[0];
+        _mm_storel_pi((__m64 *) out, rows[i]);
+        _mm_store_ss(out + 2, _mm_movehl_ps(rows[i], rows[i]));
+    }
+}
+
+static inline void __storeVec4x4(VertexData *d, glm::vec4 VertexData::*field, __m128 x, __m128 y, __m128 z, __m128 w) {
+    _MM_TRANSPOSE4_PS(x, y, z, w);
+    _mm_storeu_ps(&(d[0].*field)[0], x);
+    _mm_storeu_ps(&(d[1].*field)[0], y);
+    _mm_storeu_ps(&(d[2].*field)[0], z);
+    _mm_storeu_ps(&(d[3].*field)[0], w);
+}
+
+static inline __m128 __extractChannel(__m128i color, int shift, int mask, float scale) {
+    __m128i channel = _mm_and_si128(_mm_srli_epi32(color, shift), _mm_set1_epi32(mask));
+    return __convertAttribute(channel, scale);
+}
+
+static void __decodeWeightsSIMD(const GPUState::VertexInfo& info, const uint8_t *const v[4], VertexData *d) {
+    static constexpr float scales[4] = { 0.f, 1.f / 128.f, 1.f / 32768.f, 1.f };
+    const __m128 scale = _mm_set1_ps(scales[info.wt]);
+
+    for (int i = 0; i < 4; i++) {
+        alignas(16) int32_t raw[8] {};
+        alignas(16) float weights[8] {};
+
+        switch (info.wt) {
+        case 1:
+            for (int k = 0; k < info.wc; k++)
+                raw[k] = v[i][k];
+            break;
+        case 2:
+            for (int k = 0; k < info.wc; k++)
+                raw[k] = __loadAttribute<uint16_t>(v[i] + k * 2);
+            break;
+        case 3:
+            std::memcpy(weights, v[i], info.wc * sizeof(float));
+            break;
+        }
+
+        if (info.wt != 3) {
+            _mm_store_ps(&weights[0], _mm_mul_ps(_mm_cvtepi32_ps(_mm_load_si128((const __m128i *) &raw[0])), scale));
+            _mm_store_ps(&weights[4], _mm_mul_ps(_mm_cvtepi32_ps(_mm_load_si128((const __m128i *) &raw[4])), scale));
+        }
+        std::memcpy(d[i].w, weights, sizeof weights);
+    }
+}
+
+static void __decodeTextureCoordSIMD(const GPUState::VertexInfo& info, const uint8_t *const v[4], VertexData *d) {
+    uint32_t offset = info.texture_offset;
+    __m128 u, t;
+
+    // through mode uses texel units, transform mode normalises the fixed point formats
+    switch (info.tt) {
+    case 1:
+    {
+        float scale = info.tm ? 1.f : 1.f / 128.f;
+        u = __convertAttribute(__gatherAttribute<uint8_t>(v, offset), scale);
+        t = __convertAttribute(__gatherAttribute<uint8_t>(v, offset + 1), scale);
+        break;
+    }
+    case 2:
+    {
+        float scale = info.tm ? 1.f : 1.f / 32768.f;
+        u = __convertAttribute(__gatherAttribute<uint16_t>(v, offset), scale);
+        t = __convertAttribute(__gatherAttribute<uint16_t>(v, offset + 2), scale);
+        break;
+    }
+    default:
+        u = __gatherFloatAttribute(v, offset);
+        t = __gatherFloatAttribute(v, offset + 4);
+        break;
+    }
+
+    __storeVec2x4(d, &VertexData::uv, u, t);
+}
+
+static void __decodeColorSIMD(const GPUState::VertexInfo& info, const uint8_t *const v[4], VertexData *d) {
+    uint32_t offset = info.color_offset;
+    __m128 r, g, b, a;
+
+    switch (info.ct) {
+    case 4: // GU_COLOR_5650
+    {
+        __m128i c = __gatherAttribute<uint16_t>(v, offset);
+        r = __extractChannel(c, 0, 0x1F, 1.f / 31.f);
+        g = __extractChannel(c, 5, 0x3F, 1.f / 63.f);
+        b = __extractChannel(c, 11, 0x1F, 1.f / 31.f);
+        a = _mm_set1_ps(1.f);
+        break;
+    }
+    case 5: // GU_COLOR_5551
+    {
+        __m128i c = __gatherAttribute<uint16_t>(v, offset);
+        r = __extractChannel(c, 0, 0x1F, 1.f / 31.f);
+        g = __extractChannel(c, 5, 0x1F, 1.f / 31.f);
+        b = __extractChannel(c, 10, 0x1F, 1.f / 31.f);
+        a = __extractChannel(c, 15, 0x01, 1.f);
+        break;
+    }
+    case 6: // GU_COLOR_4444
+    {
+        __m128i c = __gatherAttribute<uint16_t>(v, offset);
+        r = __extractChannel(c, 0, 0xF, 1.f / 15.f);
+        g = __extractChannel(c, 4, 0xF, 1.f / 15.f);
+        b = __extractChannel(c, 8, 0xF, 1.f / 15.f);
+        a = __extractChannel(c, 12, 0xF, 1.f / 15.f);
+        break;
+    }
+    case 7: // GU_COLOR_8888
+    {
+        __m128i c = __gatherAttribute<uint32_t>(v, offset);
+        r = __extractChannel(c, 0, 0xFF, 1.f / 255.f);
+        g = __extractChannel(c, 8, 0xFF, 1.f / 255.f);
+        b = __extractChannel(c, 16, 0xFF, 1.f / 255.f);
+        a = __extractChannel(c, 24, 0xFF, 1.f / 255.f);
+        break;
+    }
+    default:
+        return;
+    }
+
+    __storeVec4x4(d, &VertexData::color, r, g, b, a);
+}
+
+static void __decodeNormalSIMD(const GPUState::VertexInfo& info, const uint8_t *const v[4], VertexData *d) {
+    uint32_t offset = info.normal_offset;
+    __m128 x, y, z;
+
+    switch (info.nt) {
+    case 1:
+        x = __convertAttribute(__gatherAttribute<int8_t>(v, offset), 1.f / 127.f);
+        y = __convertAttribute(__gatherAttribute<int8_t>(v, offset + 1), 1.f / 127.f);
+        z = __convertAttribute(__gatherAttribute<int8_t>(v, offset + 2), 1.f / 127.f);
+        break;
+    case 2:
+        x = __convertAttribute(__gatherAttribute<int16_t>(v, offset), 1.f / 32767.f);
+        y = __convertAttribute(__gatherAttribute<int16_t>(v, offset + 2), 1.f / 32767.f);
+        z = __convertAttribute(__gatherAttribute<int16_t>(v, offset + 4), 1.f / 32767.f);
+        break;
+    default:
+        x = __gatherFloatAttribute(v, offset);
+        y = __gatherFloatAttribute(v, offset + 4);
+        z = __gatherFloatAttribute(v, offset + 8);
+        break;
+    }
+
+    __storeVec3x4(d, &VertexData::normal, x, y, z);
+}
+
+static void __decodePositionSIMD(const GPUState::VertexInfo& info, const uint8_t *const v[4], VertexData *d) {
+    uint32_t offset = info.position_offset;
+    __m128 x, y, z;
+
+    // through mode keeps screen coordinates as is with an unsigned depth
+    switch (info.vt) {
+    case 1:
+        if (info.tm) {
+            x = __convertAttribute(__gatherAttribute<int8_t>(v, offset), 1.f);
+            y = __convertAttribute(__gatherAttribute<int8_t>(v, offset + 1), 1.f);
+            z = __convertAttribute(__gatherAttribute<uint8_t>(v, offset + 2), 1.f);
+        } else {
+            x = __convertAttribute(__gatherAttribute<int8_t>(v, offset), 1.f / 127.f);
+            y = __convertAttribute(__gatherAttribute<int8_t>(v, offset + 1), 1.f / 127.f);
+            z = __convertAttribute(__gatherAttribute<int8_t>(v, offset + 2), 1.f / 127.f);
+        }
+        break;
+    case 2:
+        if (info.tm) {
+            x = __convertAttribute(__gatherAttribute<int16_t>(v, offset), 1.f);
+            y = __convertAttribute(__gatherAttribute<int16_t>(v, offset + 2), 1.f);
+            z = __convertAttribute(__gatherAttribute<uint16_t>(v, offset + 4), 1.f);
+        } else {
+            x = __convertAttribute(__gatherAttribute<int16_t>(v, offset), 1.f / 32767.f);
+            y = __convertAttribute(__gatherAttribute<int16_t>(v, offset + 2), 1.f / 32767.f);
+            z = __convertAttribute(__gatherAttribute<int16_t>(v, offset + 4), 1.f / 32767.f);
+        }
+        break;
+    default:
+        x = __gatherFloatAttribute(v, offset);
+        y = __gatherFloatAttribute(v, offset + 4);
+        z = __gatherFloatAttribute(v, offset + 8);
+        break;
+    }
+
+    __storeVec3x4(d, &VertexData::position, x, y, z);
+}
+
+static void __decodeAttributesSIMD(const GPUState::VertexInfo& info, const uint8_t *const v[4], VertexData *d) {
+    if (!info.tm && info.wt)
+        __decodeWeightsSIMD(info, v, d);
+    if (info.tt)
+        __decodeTextureCoordSIMD(info, v, d);
+    if (info.ct >= 4)
+        __decodeColorSIMD(info, v, d);
+    if (!info.tm && info.nt)
+        __decodeNormalSIMD(info, v, d);
+    if (info.vt)
+        __decodePositionSIMD(info, v, d);
+}
+
+// every attribute of a morph target is scaled by the same weight, so the targets are
+// decoded one at a time and accumulated over the whole VertexData as packed floats
+static void __decodeMorphedAttributesSIMD(const GPUState::VertexInfo& info, const float *morphingWeights, const uint8_t *const v[4], VertexData *d) {
+    static_assert(sizeof(VertexData) % sizeof(__m128) == 0, "VertexData must be a whole number of vectors");
+    constexpr int vectorsPerVertex = 4 * sizeof(VertexData) / sizeof(__m128);
+
+    for (uint32_t morph = 0; morph < info.mc; morph++) {
+        const uint8_t *target[4];
+        for (int k = 0; k < 4; k++)
+            target[k] = v[k] + morph * info.one_vertex_size;
+
+        VertexData decoded[4] {};
+        __decodeAttributesSIMD(info, target, decoded);
+
+        __m128 weight = _mm_set1_ps(morphingWeights[morph]);
+        float *src = (float *) decoded;
+        float *dst = (float *) d;
+        for (int j = 0; j < vectorsPerVertex; j++)
+            _mm_storeu_ps(dst + j * 4, _mm_add_ps(_mm_loadu_ps(dst + j * 4), _mm_mul_ps(_mm_loadu_ps(src + j * 4), weight)));
+    }
+}
+
+static bool __decodeVertexListSIMD(const GPUState::VertexInfo& info, const float *morphingWeights, const uint8_t *inVertices, const void *inIndices, int count, std::vector<VertexData>& out) {
+    // through mode ignores morphing for texture coordinates and positions, leave it to the scalar path
+    if (info.it == 3 || (info.tm && info.mc != 1))
+        return false;
+
+    out.assign(count, VertexData {});
+
+    auto vertexAddress = [&](int i) -> const uint8_t * {
+        int index = i;
+        if (inIndices != nullptr) {
+            switch (info.it) {
+            case 1: index = ((const uint8_t *) inIndices)[i]; break;
+            case 2: index = ((const uint16_t *) inIndices)[i]; break;
+            }
+        }
+        return inVertices + info.vertex_size * index;
+    };
+
+    auto decode = [&](const uint8_t *const v[4], VertexData *d) {
+        if (info.mc == 1)
+            __decodeAttributesSIMD(info, v, d);
+        else
+            __decodeMorphedAttributesSIMD(info, morphingWeights, v, d);
+    };
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const uint8_t *v[4] = { vertexAddress(i), vertexAddress(i + 1), vertexAddress(i + 2), vertexAddress(i + 3) };
+        decode(v, &out[i]);
+    }
+
+    // the tail is padded by repeating the last vertex, only the valid outputs are kept
+    if (i < count) {
+        VertexData tail[4] {};
+        const uint8_t *v[4];
+        for (int k = 0; k < 4; k++)
+            v[k] = vertexAddress(std::min(i + k, count - 1));
+
+        decode(v, tail);
+
+        for (int k = 0; i + k < count; k++)
+            out[i + k] = tail[k];
+    }
+    return true;
+}
+#endif
+
+static std::vector<VertexData> __decodeVertices(const GPUState *state, const char *inVertices, const void *inIndices, int count) {
     std::vector<VertexData> _data;
     const GPUState::VertexInfo& vertexInfo = state->vertexInfo;
 
     float morphingWeights[8];
     std::memcpy(morphingWeights, state->morphingWeights, sizeof state->morphingWeights);
 
-    if (vertexInfo.mc == 1 && !vertexInfo.wt) {
+    // morph weights only apply when the vertex type carries more than one morph target
+    if (vertexInfo.mc == 1) {
         morphingWeights[0] = 1.0f;
     }
 
-    for (int i = 0; i < 8; i++) {
-        if (morphingWeights[i] == 0.f)
-            morphingWeights[i] = 1.f;
-    }
-
     typedef int32_t s32;
     typedef uint32_t u32;
     typedef uint16_t u16;
@@ -163,16 +665,10 @@ std::vector<VertexData> __decodeVertexList(const GPUState *state, int type, int
     typedef int8_t s8;
     typedef float f32;
 
-    char *inVertices = (char *) Core::Memory::getPointerUnchecked(state->vertexListAddress);
-    if (!inVertices) {
-        LOG_ERROR(logType, "can't get vertex pointer from list address 0x%08x!", state->vertexListAddress);
+#if defined(SIMD_SSE2)
+    if (__decodeVertexListSIMD(vertexInfo, morphingWeights, (const uint8_t *) inVertices, inIndices, count, _data))
         return _data;
-    }
-
-    void *inIndices = nullptr;
-    if (state->indexListAddress != 0) {
-        inIndices = Core::Memory::getPointerUnchecked(state->indexListAddress);
-    }
+#endif
 
     for (int i = 0; i < count; i++) {
         VertexData data {};
@@ -191,7 +687,7 @@ std::vector<VertexData> __decodeVertexList(const GPUState *state, int type, int
             }
         }
 
-        char *vertex_address = ((char *)inVertices) + (vertexInfo.vertex_size * current_address);
+        const char *vertex_address = inVertices + (vertexInfo.vertex_size * current_address);
 
         // weights
         if (!vertexInfo.tm && vertexInfo.wt)
@@ -310,6 +806,7 @@ std::vector<VertexData> __decodeVertexList(const GPUState *state, int type, int
                 data.color[2] += b * morphingWeights[morphcounter];
                 data.color[3] += morphingWeights[morphcounter];
             }
+            break;
             case 5: // GU_COLOR_5551
             for (u32 morphcounter = 0; morphcounter < vertexInfo.mc; morphcounter++)
             {
@@ -326,6 +823,7 @@ std::vector<VertexData> __decodeVertexList(const GPUState *state, int type, int
                 data.color[2] += b * morphingWeights[morphcounter];
                 data.color[3] += a * morphingWeights[morphcounter];
             }
+            break;
             case 6: // GU_COLOR_4444
             for (u32 morphcounter = 0; morphcounter < vertexInfo.mc; morphcounter++)
             {
@@ -484,10 +982,40 @@ std::vector<VertexData> __decodeVertexList(const GPUState *state, int type, int
 
         _data.push_back(data);
     }
+    return _data;
+}
 
-    if (type == GE_PRIM_RECTANGLES)
-        _data = __triangulateRectangle(_data);
+DecodedVertexList __decodeVertexList(const GPUState *state, int type, int count) {
+    DecodedVertexList list {};
+    const GPUState::VertexInfo& vertexInfo = state->vertexInfo;
 
-    return _data;
+    const char *inVertices = (const char *) Core::Memory::getPointerUnchecked(state->vertexListAddress);
+    if (!inVertices) {
+        LOG_ERROR(logType, "can't get vertex pointer from list address 0x%08x!", state->vertexListAddress);
+        return list;
+    }
+
+    const void *inIndices = nullptr;
+    if (state->indexListAddress != 0) {
+        inIndices = Core::Memory::getPointerUnchecked(state->indexListAddress);
+    }
+
+    // indexed draws decode the referenced vertex range once and hand the indices over rebased,
+    // rectangles are expanded on the cpu so they still resolve their indices here
+    if (inIndices && (vertexInfo.it == 1 || vertexInfo.it == 2) && type != GE_PRIM_RECTANGLES && count > 0) {
+        uint32_t minIndex, maxIndex;
+        __getIndexRange(inIndices, vertexInfo.it, count, minIndex, maxIndex);
+
+        list.vertices = __decodeVertices(state, inVertices + size_t(minIndex) * vertexInfo.vertex_size, nullptr, maxIndex - minIndex + 1);
+        __rebaseIndices(inIndices, vertexInfo.it, count, minIndex, list.indices);
+        list.indexType = vertexInfo.it;
+        list.indexCount = count;
+        return list;
+    }
+
+    list.vertices = __decodeVertices(state, inVertices, inIndices, count);
+    if (type == GE_PRIM_RECTANGLES)
+        list.vertices = __triangulateRectangle(list.vertices);
+    return list;
 }
 }
\ No newline at end of file
@@ -18,6 +18,17 @@ struct VertexData {
     float w[8];
 };
 
-std::vector<VertexData> *__getListFromVertexCache(const GPUState *state, int type, int count);
-std::vector<VertexData> __decodeVertexList(const GPUState *state, int type, int count);
+struct DecodedVertexList {
+    std::vector<VertexData> vertices;
+    std::vector<uint8_t> indices; // rebased to the lowest referenced vertex, 8 or 16 bit like the source list
+    int indexType; // 0 for non indexed draws, otherwise the vertex type index format (1 = u8, 2 = u16)
+    int indexCount;
+};
+
+const DecodedVertexList *__getListFromVertexCache(const GPUState *state, int type, int count);
+void __updateVertexCache(); // called once per frame, evicts old entries and keeps the cache within budget
+void __clearVertexCache();
+void setVertexCacheBudget(size_t bytes);
+size_t getVertexCacheMemorySize();
+DecodedVertexList __decodeVertexList(const GPUState *state, int type, int count);
 }
\ No newline at end of file
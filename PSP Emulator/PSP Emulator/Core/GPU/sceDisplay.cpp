@@ -1,8 +1,18 @@
+#include <algorithm>
+#include <vector>
+#include <cstring>
+
 #include <Core/GPU/sceDisplay.h>
+#include <Core/GPU/GEConstants.h>
+#include <Core/GPU/Renderer.h>
+#include <Core/GPU/TextureDecoder.h>
 
 #include <Core/Kernel/sceKernelTypes.h>
 #include <Core/Kernel/sceKernelThread.h>
 #include <Core/Kernel/sceKernelInterrupt.h>
+#include <Core/Kernel/sceKernelError.h>
+
+#include <Core/Memory/MemoryAccess.h>
 
 #include <Core/Logger.h>
 
@@ -13,11 +23,158 @@ using namespace Core::Kernel;
 namespace Core::GPU {
 static const char *logType = "sceDisplay";
 
+static constexpr int displayLineCount = 286;
+static constexpr int visibleLineCount = 272;
+static constexpr int displayWidth = 480;
+
+enum {
+    DISPLAY_SETBUF_IMMEDIATE = 0,
+    DISPLAY_SETBUF_NEXTFRAME = 1
+};
+
+struct DisplayFramebuffer {
+    uint32_t topaddr;
+    int bufferWidth;
+    int pixelFormat;
+};
+
+static int vblankEvent = -1;
+static uint64_t vblankBaseCycles;
+static uint64_t lastVblankCycles;
+static uint32_t vcount;
+
+static DisplayFramebuffer framebuffer, latchedFramebuffer; // latched is applied at the next vblank
+static bool framebufferLatched;
+static DisplayFramebuffer convertedFramebuffer; // what displayPixels was converted from
+static bool convertedValid;
+static uint64_t flipWriteStamp;
+static std::vector<uint32_t> displayPixels; // bottom-up so a run of screen rows is one block of texture rows
+
+// 59.94 Hz is 60000/1001, vblanks are placed from their number so rounding never accumulates
+static uint64_t __getVblankCycles(uint64_t frame) {
+    return vblankBaseCycles + frame * Core::Timing::getClockFrequency() * 1001 / 60000;
+}
+
+static uint64_t __getFrameCycles() {
+    return Core::Timing::getClockFrequency() * 1001 / 60000;
+}
+
+static void __convertRow(const uint8_t *in, uint32_t *out, int pixelFormat) {
+    if (pixelFormat == CMODE_FORMAT_32BIT_ABGR8888)
+        std::memcpy(out, in, displayWidth * sizeof(uint32_t));
+    else
+        __convertColors16((const uint16_t *) in, out, displayWidth, pixelFormat);
+}
+
+// only the rows whose pages were written since the last flip are converted and uploaded
+static void __flip() {
+    if (framebufferLatched) {
+        framebuffer = latchedFramebuffer;
+        framebufferLatched = false;
+    }
+
+    if (framebuffer.topaddr == 0) {
+        convertedValid = false;
+        return;
+    }
+
+    int bytesPerPixel = framebuffer.pixelFormat == CMODE_FORMAT_32BIT_ABGR8888 ? 4 : 2;
+    uint32_t rowBytes = framebuffer.bufferWidth * bytesPerPixel;
+    uint32_t lastAddress = framebuffer.topaddr + (visibleLineCount - 1) * rowBytes + displayWidth * bytesPerPixel - 1;
+
+    // the GE output stays on screen until the CPU writes the framebuffer after it, frames
+    // without any draw (30 fps games) keep showing it too
+    if (__RenderDevicePresentsTarget(framebuffer.topaddr, lastAddress - framebuffer.topaddr + 1)) {
+        convertedValid = false;
+        return;
+    }
+
+    const uint8_t *base = (const uint8_t *) Core::Memory::getPointer(framebuffer.topaddr);
+    if (!base || !Core::Memory::getPointer(lastAddress)) {
+        LOG_WARN(logType, "framebuffer 0x%08x is out of memory", framebuffer.topaddr);
+        convertedValid = false;
+        return;
+    }
+
+    // no read watch here, that would write a render target back over what the CPU wrote
+    // and keep reading it back every frame. targets are presented directly above
+    bool fullFlip = !convertedValid || std::memcmp(&convertedFramebuffer, &framebuffer, sizeof framebuffer) != 0;
+    uint64_t stamp = flipWriteStamp;
+    flipWriteStamp = Core::Memory::takeWriteStamp();
+    convertedFramebuffer = framebuffer;
+    convertedValid = true;
+
+    RenderDevice *device = getRenderDevice();
+    int runStart = -1;
+    for (int y = 0; y <= visibleLineCount; y++) {
+        uint32_t rowAddress = framebuffer.topaddr + y * rowBytes;
+        if (y < visibleLineCount && (fullFlip || Core::Memory::isWrittenSince(rowAddress, displayWidth * bytesPerPixel, stamp))) {
+            __convertRow(base + y * rowBytes, &displayPixels[(visibleLineCount - 1 - y) * displayWidth], framebuffer.pixelFormat);
+            if (runStart == -1)
+                runStart = y;
+        } else if (runStart != -1) {
+            // screen rows [runStart, y) are texture rows [visibleLineCount - y, visibleLineCount - runStart)
+            __openglUpdateFramebuffer(device, displayPixels.data(), 0, visibleLineCount - y, displayWidth, y - runStart);
+            runStart = -1;
+        }
+    }
+}
+
+static void __vblank(uint64_t userdata, int64_t cyclesLate) {
+    lastVblankCycles = Core::Timing::getCurrentCycles() - cyclesLate;
+    vcount++;
+
+    __flip();
+
+    // every WAITTYPE_VBLANK thread waiting on an older vcount is woken by the event loop
+    if (__hleInterruptsEnabled())
+        hleTriggerInterrupt(30, -1);
+
+    Core::Timing::scheduleEvent(__getVblankCycles(vcount + 1) - Core::Timing::getCurrentCycles(), vblankEvent);
+}
+
+void __displayInitialize() {
+    vblankEvent = Core::Timing::registerEvent("vblank", __vblank);
+    Core::Timing::unscheduleEvent(vblankEvent);
+
+    vcount = 0;
+    framebuffer = latchedFramebuffer = {};
+    framebufferLatched = false;
+    convertedValid = false;
+    flipWriteStamp = 0;
+    displayPixels.assign(displayWidth * visibleLineCount, 0);
+
+    vblankBaseCycles = lastVblankCycles = Core::Timing::getCurrentCycles();
+    Core::Timing::scheduleEvent(__getVblankCycles(1) - Core::Timing::getCurrentCycles(), vblankEvent);
+}
+
+void __displayShutdown() {
+    if (vblankEvent != -1)
+        Core::Timing::unscheduleEvent(vblankEvent);
+}
+
+uint32_t __displayGetVcount() {
+    return vcount;
+}
+
+uint32_t __displayGetFramebufferAddress() {
+    return framebuffer.topaddr;
+}
+
+const uint32_t *__displayGetPixels() {
+    return displayPixels.data();
+}
+
+static bool __isVblank() {
+    uint64_t vblankCycles = __getFrameCycles() * (displayLineCount - visibleLineCount) / displayLineCount;
+    return Core::Timing::getCurrentCycles() - lastVblankCycles < vblankCycles;
+}
+
 static void __waitVblankStart(bool handleCallbacks = false) {
     if (handleCallbacks)
         hleCurrentThreadEnableCallbackState();
 
-    current->waitData[0] = Core::Timing::msToCycles(16.67f) + Core::Timing::getCurrentCycles();
+    current->waitData[0] = vcount;
     threadAddToWaitingList(current, 0, WAITTYPE_VBLANK);
 }
 
@@ -34,20 +191,67 @@ int sceDisplayWaitVblankStart() {
 }
 
 int sceDisplayWaitVblank() {
-    Core::Timing::consumeCycles(1110);
+    if (!__isVblank())
+        __waitVblankStart();
     // LOG_WARN(logType, "unimplemented sceDisplayWaitVblank");
     return 0;
 }
 
 int sceDisplayIsVblank() {
-    return 1;
+    return __isVblank();
 }
 
 int sceDisplayGetCurrentHcount() {
-    return 0;
+    uint64_t lineCycles = __getFrameCycles() / displayLineCount;
+    uint64_t line = (Core::Timing::getCurrentCycles() - lastVblankCycles) / lineCycles;
+    return (int) std::min<uint64_t>(line, displayLineCount - 1); // the line within the current frame
 }
 
 int sceDisplayGetVcount() {
+    return (int) vcount;
+}
+
+int sceDisplaySetFrameBuf(uint32_t topaddr, int bufferWidth, int pixelFormat, int sync) {
+    if (bufferWidth < 0 || (bufferWidth & 0x3F) != 0 || (bufferWidth == 0) != (topaddr == 0)) {
+        LOG_WARN(logType, "sceDisplaySetFrameBuf invalid buffer width %d", bufferWidth);
+        return SCE_KERNEL_ERROR_INVALID_SIZE;
+    }
+
+    if ((topaddr & 0xF) != 0) {
+        LOG_WARN(logType, "sceDisplaySetFrameBuf misaligned address 0x%08x", topaddr);
+        return SCE_KERNEL_ERROR_INVALID_POINTER;
+    }
+
+    if (pixelFormat < CMODE_FORMAT_16BIT_BGR5650 || pixelFormat > CMODE_FORMAT_32BIT_ABGR8888) {
+        LOG_WARN(logType, "sceDisplaySetFrameBuf invalid pixel format %d", pixelFormat);
+        return SCE_KERNEL_ERROR_INVALID_FORMAT;
+    }
+
+    if (sync != DISPLAY_SETBUF_IMMEDIATE && sync != DISPLAY_SETBUF_NEXTFRAME) {
+        LOG_WARN(logType, "sceDisplaySetFrameBuf invalid sync mode %d", sync);
+        return SCE_KERNEL_ERROR_INVALID_MODE;
+    }
+
+    DisplayFramebuffer newFramebuffer { .topaddr = topaddr, .bufferWidth = bufferWidth, .pixelFormat = pixelFormat };
+    if (sync == DISPLAY_SETBUF_IMMEDIATE) {
+        framebuffer = newFramebuffer;
+        framebufferLatched = false;
+    } else {
+        latchedFramebuffer = newFramebuffer;
+        framebufferLatched = true;
+    }
+    return 0;
+}
+
+int sceDisplayGetFrameBuf(uint32_t topaddrPointer, uint32_t bufferWidthPointer, uint32_t pixelFormatPointer, int sync) {
+    const DisplayFramebuffer& current = sync == DISPLAY_SETBUF_NEXTFRAME && framebufferLatched ? latchedFramebuffer : framebuffer;
+
+    if (topaddrPointer)
+        Core::Memory::write32(topaddrPointer, current.topaddr);
+    if (bufferWidthPointer)
+        Core::Memory::write32(bufferWidthPointer, current.bufferWidth);
+    if (pixelFormatPointer)
+        Core::Memory::write32(pixelFormatPointer, current.pixelFormat);
     return 0;
 }
 }
\ No newline at end of file
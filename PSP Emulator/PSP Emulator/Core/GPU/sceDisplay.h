@@ -1,6 +1,17 @@
 #pragma once
 
+#include <cstdint>
+
 namespace Core::GPU {
+void __displayInitialize();
+void __displayShutdown();
+uint32_t __displayGetVcount();
+uint32_t __displayGetFramebufferAddress();
+const uint32_t *__displayGetPixels(); // last flipped framebuffer as RGBA, 480x272 bottom-up
+
+int sceDisplaySetFrameBuf(uint32_t topaddr, int bufferWidth, int pixelFormat, int sync);
+int sceDisplayGetFrameBuf(uint32_t topaddrPointer, uint32_t bufferWidthPointer, uint32_t pixelFormatPointer, int sync);
+
 int sceDisplayWaitVblankStartCB();
 int sceDisplayWaitVblankStart();
 int sceDisplayWaitVblank();
@@ -177,12 +177,16 @@ int __hleIoRead(SceUID fd, uint32_t data, SceSize size) {
 
         if (it->second.info.logicalBlockAddress != -1) {
             loader->seek((uint64_t) it->second.info.logicalBlockAddress * 0x800 + it->second.offset, SEEK_SET);
-            if (newSize != 0)
+            if (newSize != 0) {
                 loader->read(Core::Memory::getPointerUnchecked(data), newSize);
+                Core::Memory::markWritten(data, newSize);
+            }
         } else {
             loader->seek(it->second.offset << 11, SEEK_SET);
-            if (newSize != 0)
+            if (newSize != 0) {
                 loader->read(Core::Memory::getPointerUnchecked(data), (uint64_t)newSize << 11);
+                Core::Memory::markWritten(data, newSize << 11);
+            }
         }
 
         it->second.offset += newSize;
@@ -194,6 +198,7 @@ int __hleIoRead(SceUID fd, uint32_t data, SceSize size) {
         it->second.offset += newSize;
         if (newSize != 0) {
             fread(Core::Memory::getPointerUnchecked(data), newSize, 1, fp);
+            Core::Memory::markWritten(data, newSize);
         }
 
         fclose(fp);
@@ -1,11 +1,80 @@
 #pragma once
 
+#include <cstddef>
 #include <vector>
 
 namespace Core::DS {
+// link embedded in the cached object, copying an object never copies its place in a list
+struct LRUNode {
+    LRUNode *prev = nullptr, *next = nullptr;
+    void *owner = nullptr; // the object holding the node, set when it's linked
+
+    LRUNode() = default;
+    LRUNode(const LRUNode&) {}
+    LRUNode& operator=(const LRUNode&) { return *this; }
+
+    bool isLinked() const { return prev != nullptr; }
+};
+
+// intrusive least recently used list, the objects stay owned by their container
+// (they must not move while linked) and every operation is O(1)
+template<typename T, LRUNode T::*Node>
 struct LRU {
 private:
+    LRUNode head; // head.next is the most recently used, head.prev the least
+    size_t count;
+
+    static T *owner(LRUNode *node) {
+        return static_cast<T *>(node->owner);
+    }
+
+    void unlink(LRUNode *node) {
+        node->prev->next = node->next;
+        node->next->prev = node->prev;
+        node->prev = node->next = nullptr;
+    }
 public:
+    LRU() : count(0) {
+        head.prev = head.next = &head;
+    }
+
+    LRU(const LRU&) = delete;
+    LRU& operator=(const LRU&) = delete;
+
+    // links the object as the most recently used one
+    void touch(T *object) {
+        LRUNode *node = &(object->*Node);
+        if (node->isLinked())
+            unlink(node);
+        else
+            count++;
+
+        node->owner = object;
+        node->prev = &head;
+        node->next = head.next;
+        head.next->prev = node;
+        head.next = node;
+    }
+
+    void remove(T *object) {
+        LRUNode *node = &(object->*Node);
+        if (!node->isLinked())
+            return;
+
+        unlink(node);
+        count--;
+    }
+
+    T *leastRecentlyUsed() {
+        return count != 0 ? owner(head.prev) : nullptr;
+    }
+
+    void clear() {
+        while (count != 0)
+            remove(owner(head.prev));
+    }
 
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
 };
 }
\ No newline at end of file
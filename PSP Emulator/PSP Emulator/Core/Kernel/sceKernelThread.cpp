@@ -35,6 +35,7 @@
 
 #include <Core/GPU/DisplayList.h>
 #include <Core/GPU/GPU.h>
+#include <Core/GPU/sceDisplay.h>
 
 #include <Core/Logger.h>
 
@@ -1012,6 +1013,8 @@ static void hleThreadHandleInterrupts() {
 static void hleHandleEvents() {
     std::vector<int> awakenedThreads;
 
+    Core::Timing::runEvents();
+
     for (auto thrUID = threadWaitingList.begin(); thrUID != threadWaitingList.end(); ) {
         auto i = getKernelObject<PSPThread>(*thrUID);
 
@@ -1026,18 +1029,10 @@ static void hleHandleEvents() {
                 awakenedThreads.push_back(i->getUID());
             break;
         case WAITTYPE_VBLANK:
-        {
-            int64_t vblankRefreshCycleCount = Core::Timing::msToCycles(16.67f);
-            static uint64_t oldVblankCycleCounter = vblankRefreshCycleCount;
-
-            if (auto cycles = Core::Timing::getBaseCycles(); oldVblankCycleCounter < cycles) {
-                int64_t cyclesCount = Core::Timing::getCurrentCycles() - Core::Timing::getBaseCycles();
-                Core::Timing::consumeCycles(cyclesCount);
-                oldVblankCycleCounter = cycles + vblankRefreshCycleCount;
+            // waitData[0] holds the vcount the thread started waiting at
+            if (Core::GPU::__displayGetVcount() != (uint32_t) i->waitData[0])
                 awakenedThreads.push_back(i->getUID());
-            }
             break;
-        }
         case WAITTYPE_DELAY:
         {
             auto futureCycles = i->waitData[0];
@@ -1157,10 +1152,6 @@ static void hleHandleEvents() {
             ++it;
     }
 
-    if (__hleInterruptsEnabled()) {
-        hleTriggerInterrupt(30, -1);
-    }
-
     for (auto& i : awakenedThreads)
         doWakeup(i);
 
@@ -1196,8 +1187,9 @@ void hleThreadRunFor(uint64_t cycles) {
         if (!current)
             break;
 
-        Core::Timing::getCurrentCycles();
-        Core::Timing::setDowncount(Core::Timing::getTimesliceQuantum());
+        // the slice ends early when an event is due so it isn't run late
+        int64_t untilEvent = std::max<int64_t>(Core::Timing::getCyclesUntilNextEvent(), 1);
+        Core::Timing::setDowncount(std::min<int64_t>(Core::Timing::getTimesliceQuantum(), untilEvent));
         int64_t& dc = Core::Timing::getDowncount();
 
         // printf("%d %d\n", Core::Timing::getSystemTimeMilliseconds(), Core::Timing::getCurrentCycles());
@@ -1,5 +1,7 @@
 #include <Core/Memory/MemoryAccess.h>
 
+#include <algorithm>
+
 #include <Core/PSP/MemoryMap.h>
 #include <Core/Logger.h>
 #include <Core/Allegrex/AllegrexState.h>
@@ -9,6 +11,30 @@ static const char *logType = "MemoryAccess";
 
 extern uint8_t *scratchpad, *userMemory, *videoMemory, *kernelMemory;
 
+static constexpr uint32_t PAGE_SHIFT = 12;
+static constexpr uint32_t MAIN_MEMORY_BASE = 0x08000000;
+static constexpr uint32_t MAIN_MEMORY_SIZE = Core::PSP::KERNELSPACE_MEMORY_SIZE + Core::PSP::USERSPACE_MEMORY_SIZE;
+static constexpr uint32_t VIDEO_MEMORY_BASE = 0x04000000;
+
+static uint64_t mainMemoryPageStamp[MAIN_MEMORY_SIZE >> PAGE_SHIFT];
+static uint64_t videoMemoryPageStamp[Core::PSP::VRAM_MEMORY_SIZE >> PAGE_SHIFT];
+static uint64_t writeStamp = 1;
+
+static uint8_t videoMemoryReadWatch[Core::PSP::VRAM_MEMORY_SIZE >> PAGE_SHIFT]; // watchers per page
+static ReadWatchHandler readWatchHandler;
+uint32_t watchedPageCount;
+
+static inline uint64_t *__getPageStamp(uint32_t address) {
+    address &= 0x0FFFFFFF; // cached and uncached mirrors share their pages
+
+    if (address - MAIN_MEMORY_BASE < MAIN_MEMORY_SIZE)
+        return &mainMemoryPageStamp[(address - MAIN_MEMORY_BASE) >> PAGE_SHIFT];
+
+    if (address - VIDEO_MEMORY_BASE < Core::PSP::VRAM_MEMORY_SIZE)
+        return &videoMemoryPageStamp[(address - VIDEO_MEMORY_BASE) >> PAGE_SHIFT];
+    return nullptr;
+}
+
 namespace Utility {
 bool isValidAddress(uint32_t address) {
     if (address >= 0x00010000 && address <= 0x00013FFF)
@@ -71,7 +97,9 @@ bool copyMemoryGuestToGuest(uint32_t dst, uint32_t src, uint32_t size) {
         return false;
     }
 
+    checkReads(src, size);
     std::memcpy(getPointer(dst), getPointer(src), size);
+    markWritten(dst, size);
     // LOG_TRACE(logType, "%s: [copied 0x%08x to 0x%08x, size 0x%08x]", __func__, src, dst, size);
     return true;
 }
@@ -83,6 +111,7 @@ bool copyMemoryHostToGuest(uint32_t dst, const void *src, uint32_t size) {
     }
 
     std::memcpy(getPointer(dst), src, size);
+    markWritten(dst, size);
     // LOG_TRACE(logType, "%s: [copied %p to 0x%08x, size 0x%08x]", __func__, src, dst, size);
     return true;
 }
@@ -93,6 +122,7 @@ bool copyMemoryGuestToHost(void *dst, uint32_t src, uint32_t size) {
         return false;
     }
 
+    checkReads(src, size);
     std::memcpy(dst, getPointer(src), size);
     // LOG_TRACE(logType, "%s: [copied 0x%08x to %p, size 0x%08x]", __func__, src, dst, size);
     return true;
@@ -105,6 +135,7 @@ bool memorySet(uint32_t address, uint8_t c, uint32_t size) {
     }
 
     std::memset(getPointer(address), c, size);
+    markWritten(address, size);
     // LOG_TRACE(logType, "%s: [0x%08x set to 0x%02x, size 0x%08x]", __func__, address, c, size);
     return true;
 }
@@ -143,6 +174,7 @@ void *getPointer(uint32_t address) {
 }
 
 uint8_t read8(uint32_t address) {
+    checkReads(address, sizeof(uint8_t));
     uint8_t *ptr = (uint8_t *)getPointer(address);
     if (ptr)
         return *ptr;
@@ -152,11 +184,14 @@ uint8_t read8(uint32_t address) {
 void write8(uint32_t address, uint8_t value) {
     uint8_t *ptr = (uint8_t *)getPointer(address);
 
-    if (ptr)
+    if (ptr) {
         *ptr = value;
+        markPageWritten(address);
+    }
 }
 
 uint16_t read16(uint32_t address) {
+    checkReads(address, sizeof(uint16_t));
     uint16_t *ptr = (uint16_t *)getPointer(address);
     if (ptr)
         return *ptr;
@@ -166,11 +201,14 @@ uint16_t read16(uint32_t address) {
 void write16(uint32_t address, uint16_t value) {
     uint16_t *ptr = (uint16_t *)getPointer(address);
 
-    if (ptr)
+    if (ptr) {
         *ptr = value;
+        markPageWritten(address);
+    }
 }
 
 uint32_t read32(uint32_t address) {
+    checkReads(address, sizeof(uint32_t));
     uint32_t *ptr = (uint32_t *)getPointer(address);
     if (ptr)
         return *ptr;
@@ -180,11 +218,14 @@ uint32_t read32(uint32_t address) {
 void write32(uint32_t address, uint32_t value) {
     uint32_t *ptr = (uint32_t *)getPointer(address);
 
-    if (ptr)
+    if (ptr) {
         *ptr = value;
+        markPageWritten(address);
+    }
 }
 
 float readFloat32(uint32_t address) {
+    checkReads(address, sizeof(float));
     float *ptr = (float *)getPointer(address);
 
     if (ptr)
@@ -199,10 +240,82 @@ void writeFloat32(uint32_t address, float value) {
 
     if (ptr) {
         *ptr = value;
+        markPageWritten(address);
         return;
     }
 
     printf("invalid float write\n");
 }
 
+void markPageWritten(uint32_t address) {
+    if (uint64_t *stamp = __getPageStamp(address); stamp != nullptr)
+        *stamp = writeStamp;
+}
+
+void markWritten(uint32_t address, uint32_t size) {
+    if (size == 0)
+        return;
+
+    for (uint32_t page = address >> PAGE_SHIFT, last = (address + size - 1) >> PAGE_SHIFT; page <= last; page++)
+        markPageWritten(page << PAGE_SHIFT);
+}
+
+// returns the current stamp, stores made after this call are stamped with a later value
+uint64_t takeWriteStamp() {
+    return writeStamp++;
+}
+
+bool isWrittenSince(uint32_t address, uint32_t size, uint64_t stamp) {
+    if (size == 0)
+        return false;
+
+    for (uint32_t page = address >> PAGE_SHIFT, last = (address + size - 1) >> PAGE_SHIFT; page <= last; page++) {
+        const uint64_t *pageStamp = __getPageStamp(page << PAGE_SHIFT);
+        if (pageStamp && *pageStamp > stamp)
+            return true;
+    }
+    return false;
+}
+
+void setReadWatchHandler(ReadWatchHandler handler) {
+    readWatchHandler = handler;
+}
+
+void watchReads(uint32_t address, uint32_t size) {
+    uint32_t offset = (address & 0x0FFFFFFF) - VIDEO_MEMORY_BASE;
+    if (size == 0 || offset >= Core::PSP::VRAM_MEMORY_SIZE)
+        return;
+
+    uint32_t last = std::min(offset + size - 1, Core::PSP::VRAM_MEMORY_SIZE - 1) >> PAGE_SHIFT;
+    for (uint32_t page = offset >> PAGE_SHIFT; page <= last; page++) {
+        if (videoMemoryReadWatch[page]++ == 0)
+            watchedPageCount++;
+    }
+}
+
+void unwatchReads(uint32_t address, uint32_t size) {
+    uint32_t offset = (address & 0x0FFFFFFF) - VIDEO_MEMORY_BASE;
+    if (size == 0 || offset >= Core::PSP::VRAM_MEMORY_SIZE)
+        return;
+
+    uint32_t last = std::min(offset + size - 1, Core::PSP::VRAM_MEMORY_SIZE - 1) >> PAGE_SHIFT;
+    for (uint32_t page = offset >> PAGE_SHIFT; page <= last; page++) {
+        if (videoMemoryReadWatch[page] != 0 && --videoMemoryReadWatch[page] == 0)
+            watchedPageCount--;
+    }
+}
+
+void __handleWatchedRead(uint32_t address, uint32_t size) {
+    uint32_t offset = (address & 0x0FFFFFFF) - VIDEO_MEMORY_BASE;
+    if (size == 0 || !readWatchHandler)
+        return;
+
+    uint32_t last = std::min(offset + size - 1, Core::PSP::VRAM_MEMORY_SIZE - 1) >> PAGE_SHIFT;
+    for (uint32_t page = offset >> PAGE_SHIFT; page <= last; page++) {
+        if (videoMemoryReadWatch[page] != 0) {
+            readWatchHandler(VIDEO_MEMORY_BASE + offset, std::min(size, Core::PSP::VRAM_MEMORY_SIZE - offset));
+            return;
+        }
+    }
+}
 }
\ No newline at end of file
@@ -22,4 +22,27 @@ void write32(uint32_t address, uint32_t value);
 uint32_t read32(uint32_t address);
 float readFloat32(uint32_t address);
 void writeFloat32(uint32_t address, float value);
+
+// main memory and VRAM are tracked in 4KB pages, every guest store stamps the page it lands in
+// so caches holding decoded guest data can tell if it changed since they took their stamp
+void markPageWritten(uint32_t address);
+void markWritten(uint32_t address, uint32_t size);
+uint64_t takeWriteStamp();
+bool isWrittenSince(uint32_t address, uint32_t size, uint64_t stamp);
+
+// VRAM pages whose newest contents only exist on the host GPU, the handler writes them back
+// the first time the guest or the host reads one of them. checkReads must be called before
+// guest memory is read through a pointer
+typedef void (*ReadWatchHandler)(uint32_t address, uint32_t size);
+void setReadWatchHandler(ReadWatchHandler handler);
+void watchReads(uint32_t address, uint32_t size);
+void unwatchReads(uint32_t address, uint32_t size);
+void __handleWatchedRead(uint32_t address, uint32_t size);
+
+extern uint32_t watchedPageCount;
+
+inline void checkReads(uint32_t address, uint32_t size) {
+    if (watchedPageCount != 0 && (address & 0x0FFFFFFF) - 0x04000000 < 0x400000)
+        __handleWatchedRead(address, size);
+}
 }
\ No newline at end of file
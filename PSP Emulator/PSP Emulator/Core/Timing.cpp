@@ -1,4 +1,7 @@
 #include <cstdio>
+#include <string>
+#include <vector>
+#include <algorithm>
 
 #include <Core/Timing.h>
 
@@ -15,6 +18,20 @@ static uint64_t baseCycles;
 
 uint64_t idleCyclesTaken = 0;
 
+struct EventType {
+    std::string name;
+    EventCallback callback;
+};
+
+struct ScheduledEvent {
+    uint64_t time;
+    int event;
+    uint64_t userdata;
+};
+
+static std::vector<EventType> eventTypes;
+static std::vector<ScheduledEvent> scheduledEvents; // sorted by time
+
 const uint64_t& getBaseCycles() {
     return baseCycles;
 }
@@ -93,4 +110,48 @@ uint64_t usToCycles(uint64_t time) {
 uint64_t msToCycles(uint64_t time) {
     return (uint64_t)((time * getClockFrequency()) / 1000);
 }
+
+int registerEvent(const char *name, EventCallback callback) {
+    // registering again after a reset hands out the same id
+    for (size_t i = 0; i < eventTypes.size(); i++) {
+        if (eventTypes[i].name == name) {
+            eventTypes[i].callback = callback;
+            return (int) i;
+        }
+    }
+
+    eventTypes.push_back(EventType { .name = name, .callback = callback });
+    return (int) eventTypes.size() - 1;
+}
+
+void scheduleEvent(int64_t cyclesIntoFuture, int event, uint64_t userdata) {
+    uint64_t time = getCurrentCycles() + std::max<int64_t>(cyclesIntoFuture, 0);
+    auto it = std::upper_bound(scheduledEvents.begin(), scheduledEvents.end(), time,
+        [](uint64_t time, const ScheduledEvent& e) { return time < e.time; });
+    scheduledEvents.insert(it, ScheduledEvent { .time = time, .event = event, .userdata = userdata });
+}
+
+void unscheduleEvent(int event) {
+    std::erase_if(scheduledEvents, [&](const ScheduledEvent& e) { return e.event == event; });
+}
+
+void runEvents() {
+    while (!scheduledEvents.empty() && scheduledEvents.front().time <= getCurrentCycles()) {
+        ScheduledEvent e = scheduledEvents.front();
+        scheduledEvents.erase(scheduledEvents.begin());
+
+        if (e.event >= 0 && e.event < (int) eventTypes.size() && eventTypes[e.event].callback)
+            eventTypes[e.event].callback(e.userdata, (int64_t) (getCurrentCycles() - e.time));
+    }
+}
+
+int64_t getCyclesUntilNextEvent() {
+    if (scheduledEvents.empty())
+        return INT64_MAX;
+    return (int64_t) (scheduledEvents.front().time - getCurrentCycles());
+}
+
+void clearEvents() {
+    scheduledEvents.clear();
+}
 }
\ No newline at end of file
@@ -22,4 +22,15 @@ uint64_t usToCycles(double us);
 uint64_t msToCycles(double ms);
 uint64_t usToCycles(uint64_t time);
 uint64_t msToCycles(uint64_t ms);
+
+// events fire from the kernel event loop once the cycle count reaches them, callbacks
+// get how late they ran so periodic events can reschedule without drifting
+typedef void (*EventCallback)(uint64_t userdata, int64_t cyclesLate);
+
+int registerEvent(const char *name, EventCallback callback);
+void scheduleEvent(int64_t cyclesIntoFuture, int event, uint64_t userdata = 0);
+void unscheduleEvent(int event);
+void runEvents();
+int64_t getCyclesUntilNextEvent();
+void clearEvents();
 }
\ No newline at end of file
@@ -0,0 +1,75 @@
+#include <Core/Utility/Arena.h>
+
+#include <algorithm>
+#include <mutex>
+
+namespace Core::Utility {
+Arena::Arena(size_t blockSize) : offset(0), blockSize(blockSize) {
+}
+
+void Arena::addBlock(size_t size) {
+    blocks.push_back(Block { .memory = std::make_unique<uint8_t[]>(size), .size = size });
+    offset = 0;
+}
+
+void *Arena::allocate(size_t size, size_t alignment) {
+    // the block is allocated with new[], so only offsets are aligned on top of the block itself
+    if (!blocks.empty()) {
+        uintptr_t base = (uintptr_t) blocks.back().memory.get();
+        size_t aligned = ((base + offset + alignment - 1) & ~(uintptr_t) (alignment - 1)) - base;
+        if (aligned + size <= blocks.back().size) {
+            offset = aligned + size;
+            return blocks.back().memory.get() + aligned;
+        }
+    }
+
+    addBlock(std::max(blockSize, size + alignment));
+    return allocate(size, alignment);
+}
+
+void Arena::reset() {
+    if (blocks.size() > 1) {
+        size_t total = capacity();
+        blocks.clear();
+        addBlock(total);
+    }
+    offset = 0;
+}
+
+size_t Arena::capacity() const {
+    size_t total = 0;
+    for (auto& i : blocks)
+        total += i.size;
+    return total;
+}
+
+static std::mutex frameArenaMutex;
+static std::vector<Arena *> frameArenas;
+
+namespace {
+struct FrameArena {
+    Arena arena;
+
+    FrameArena() {
+        std::lock_guard<std::mutex> lock(frameArenaMutex);
+        frameArenas.push_back(&arena);
+    }
+
+    ~FrameArena() {
+        std::lock_guard<std::mutex> lock(frameArenaMutex);
+        frameArenas.erase(std::find(frameArenas.begin(), frameArenas.end(), &arena));
+    }
+};
+}
+
+Arena& getFrameArena() {
+    thread_local FrameArena frameArena;
+    return frameArena.arena;
+}
+
+void resetFrameArenas() {
+    std::lock_guard<std::mutex> lock(frameArenaMutex);
+    for (auto i : frameArenas)
+        i->reset();
+}
+}
\ No newline at end of file
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace Core::Utility {
+// bump pointer allocator for data that only lives until the end of the frame,
+// memory is handed out from large blocks and released all at once by reset()
+class Arena {
+private:
+    struct Block {
+        std::unique_ptr<uint8_t[]> memory;
+        size_t size;
+    };
+
+    std::vector<Block> blocks;
+    size_t offset;
+    size_t blockSize;
+
+    void addBlock(size_t size);
+public:
+    explicit Arena(size_t blockSize = 1024 * 1024);
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void *allocate(size_t size, size_t alignment = 64);
+
+    // after a frame that needed more than one block the blocks are merged,
+    // so the steady state is a single block sized for the busiest frame
+    void reset();
+
+    size_t capacity() const;
+};
+
+Arena& getFrameArena(); // one arena per thread, so decoders may run concurrently
+void resetFrameArenas(); // only called at the end of a frame when no decode is running
+}
\ No newline at end of file
@@ -0,0 +1,138 @@
+#include <Core/Utility/Hash.h>
+#include <Core/Utility/SIMD.h>
+
+#include <cstring>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace Core::Utility {
+static constexpr uint64_t PRIME32_1 = 0x9E3779B1uLL;
+static constexpr uint64_t PRIME64_1 = 0x9E3779B185EBCA87uLL;
+static constexpr uint64_t PRIME64_2 = 0xC2B2AE3D27D4EB4FuLL;
+static constexpr uint64_t PRIME64_3 = 0x165667B19E3779F9uLL;
+
+static constexpr size_t STRIPE_SIZE = 64;
+static constexpr size_t STRIPES_PER_BLOCK = 16;
+
+alignas(16) static const uint64_t stripeKey[8] = {
+    0xBE4BA423396CFEB8uLL, 0x1CAD21F72C81017CuLL, 0xDB979083E96DD4DEuLL, 0x1F67B3B7A4A44072uLL,
+    0x78E5C0CC4EE679CBuLL, 0x2172FFCC7DD05A82uLL, 0x8E2443F7744608B8uLL, 0x4C263A81E69035E0uLL,
+};
+
+alignas(16) static const uint64_t scrambleKey[8] = {
+    0xCB00C391BB52283CuLL, 0xA32E531B8B65D088uLL, 0x4EF90DA297486471uLL, 0xD8ACDEA946EF1938uLL,
+    0x3F349CE33F76FAA8uLL, 0x1D4F0BC7C7BBDCF9uLL, 0x3159B4CD4BE0518AuLL, 0x647378D9C97E9FC8uLL,
+};
+
+static inline uint64_t read64(const uint8_t *p) {
+    uint64_t value;
+    std::memcpy(&value, p, sizeof value);
+    return value;
+}
+
+static inline uint64_t mul128Fold64(uint64_t a, uint64_t b) {
+#if defined(_MSC_VER) && defined(_M_X64)
+    uint64_t high;
+    uint64_t low = _umul128(a, b, &high);
+    return low ^ high;
+#elif defined(__SIZEOF_INT128__)
+    unsigned __int128 product = (unsigned __int128) a * b;
+    return uint64_t(product) ^ uint64_t(product >> 64);
+#else
+    uint64_t lolo = (a & 0xFFFFFFFF) * (b & 0xFFFFFFFF);
+    uint64_t hilo = (a >> 32) * (b & 0xFFFFFFFF);
+    uint64_t lohi = (a & 0xFFFFFFFF) * (b >> 32);
+    uint64_t hihi = (a >> 32) * (b >> 32);
+    uint64_t cross = (lolo >> 32) + (hilo & 0xFFFFFFFF) + lohi;
+    uint64_t upper = (hilo >> 32) + (cross >> 32) + hihi;
+    uint64_t lower = (cross << 32) | (lolo & 0xFFFFFFFF);
+    return lower ^ upper;
+#endif
+}
+
+static inline uint64_t avalanche(uint64_t h) {
+    h ^= h >> 37;
+    h *= 0x165667919E3779F9uLL;
+    h ^= h >> 32;
+    return h;
+}
+
+#if defined(SIMD_SSE2)
+static inline void accumulateStripe(uint64_t *acc, const uint8_t *p) {
+    __m128i *a = (__m128i *) acc;
+    for (int i = 0; i < 4; i++) {
+        __m128i data = _mm_loadu_si128((const __m128i *) (p + i * 16));
+        __m128i key = _mm_load_si128((const __m128i *) &stripeKey[i * 2]);
+        __m128i dataKey = _mm_xor_si128(data, key);
+        __m128i dataKeyHigh = _mm_shuffle_epi32(dataKey, _MM_SHUFFLE(0, 3, 0, 1));
+        __m128i product = _mm_mul_epu32(dataKey, dataKeyHigh);
+        __m128i dataSwap = _mm_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2));
+        a[i] = _mm_add_epi64(a[i], _mm_add_epi64(product, dataSwap));
+    }
+}
+
+static inline void scrambleAccumulators(uint64_t *acc) {
+    __m128i *a = (__m128i *) acc;
+    const __m128i prime = _mm_set1_epi32((int) PRIME32_1);
+    for (int i = 0; i < 4; i++) {
+        __m128i value = a[i];
+        value = _mm_xor_si128(value, _mm_srli_epi64(value, 47));
+        value = _mm_xor_si128(value, _mm_load_si128((const __m128i *) &scrambleKey[i * 2]));
+        __m128i productLow = _mm_mul_epu32(value, prime);
+        __m128i productHigh = _mm_mul_epu32(_mm_shuffle_epi32(value, _MM_SHUFFLE(2, 3, 0, 1)), prime);
+        a[i] = _mm_add_epi64(productLow, _mm_slli_epi64(productHigh, 32));
+    }
+}
+#else
+static inline void accumulateStripe(uint64_t *acc, const uint8_t *p) {
+    for (int i = 0; i < 8; i++) {
+        uint64_t data = read64(p + i * 8);
+        uint64_t dataKey = data ^ stripeKey[i];
+        acc[i ^ 1] += data;
+        acc[i] += (dataKey & 0xFFFFFFFF) * (dataKey >> 32);
+    }
+}
+
+static inline void scrambleAccumulators(uint64_t *acc) {
+    for (int i = 0; i < 8; i++) {
+        uint64_t value = acc[i];
+        value ^= value >> 47;
+        value ^= scrambleKey[i];
+        acc[i] = value * PRIME32_1;
+    }
+}
+#endif
+
+uint64_t hash64(const void *data, size_t size, uint64_t seed) {
+    const uint8_t *p = (const uint8_t *) data;
+
+    alignas(16) uint64_t acc[8] = {
+        PRIME32_1, PRIME64_1 + seed, PRIME64_2, PRIME64_3 ^ seed,
+        PRIME64_2 ^ seed, PRIME32_1 + seed, PRIME64_1, PRIME64_3,
+    };
+
+    size_t stripes = size / STRIPE_SIZE;
+    for (size_t i = 0; i < stripes; i++) {
+        accumulateStripe(acc, p + i * STRIPE_SIZE);
+        if ((i % STRIPES_PER_BLOCK) == STRIPES_PER_BLOCK - 1)
+            scrambleAccumulators(acc);
+    }
+
+    if (size_t remaining = size % STRIPE_SIZE; remaining != 0) {
+        alignas(16) uint8_t last[STRIPE_SIZE] {};
+        std::memcpy(last, p + stripes * STRIPE_SIZE, remaining);
+        accumulateStripe(acc, last);
+    }
+
+    uint64_t result = uint64_t(size) * PRIME64_1 + seed;
+    for (int i = 0; i < 4; i++)
+        result += mul128Fold64(acc[i * 2] ^ scrambleKey[i * 2], acc[i * 2 + 1] ^ stripeKey[i * 2 + 1]);
+    return avalanche(result);
+}
+
+uint64_t hashCombine(uint64_t hash, uint64_t value) {
+    return avalanche(mul128Fold64(hash ^ PRIME64_1, value ^ PRIME64_2));
+}
+}
\ No newline at end of file
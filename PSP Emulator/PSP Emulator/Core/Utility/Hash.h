@@ -0,0 +1,11 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace Core::Utility {
+// 64-bit content hash in the xxHash3 family, 64 byte stripes are accumulated
+// with SSE2 when available, the scalar fallback yields the same value
+uint64_t hash64(const void *data, size_t size, uint64_t seed = 0);
+uint64_t hashCombine(uint64_t hash, uint64_t value);
+}
\ No newline at end of file
@@ -0,0 +1,24 @@
+#pragma once
+
+// SSE2 is part of the x86-64 baseline, the wider instruction sets are only
+// used when the compiler was told it may emit them (/arch:AVX2, -mavx2...).
+// the x64 release configuration builds with /arch:AVX2, debug keeps the SSE2 paths
+#if defined(_M_X64) || defined(_M_AMD64) || defined(__x86_64__) || defined(__SSE2__)
+#define SIMD_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(__SSSE3__) || defined(__AVX__)
+#define SIMD_SSSE3 1
+#include <tmmintrin.h>
+#endif
+
+#if defined(__SSE4_1__) || defined(__AVX__)
+#define SIMD_SSE41 1
+#include <smmintrin.h>
+#endif
+
+#if defined(__AVX2__)
+#define SIMD_AVX2 1
+#include <immintrin.h>
+#endif
\ No newline at end of file
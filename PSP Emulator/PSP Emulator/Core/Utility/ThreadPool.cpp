@@ -0,0 +1,110 @@
+#include <Core/Utility/ThreadPool.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+namespace Core::Utility {
+ThreadPool::ThreadPool(int threadCount) : stopping(false) {
+    for (int i = 0; i < threadCount; i++)
+        workers.emplace_back(&ThreadPool::worker, this);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+
+    condition.notify_all();
+    for (auto& i : workers)
+        i.join();
+}
+
+void ThreadPool::worker() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this] { return stopping || !tasks.empty(); });
+            if (tasks.empty())
+                return;
+
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+    }
+}
+
+std::future<void> ThreadPool::submit(std::function<void()> task) {
+    auto packagedTask = std::make_shared<std::packaged_task<void()>>(std::move(task));
+    std::future<void> future = packagedTask->get_future();
+
+    if (workers.empty()) {
+        (*packagedTask)();
+        return future;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.emplace_back([packagedTask] { (*packagedTask)(); });
+    }
+    condition.notify_one();
+    return future;
+}
+
+namespace {
+struct ParallelForState {
+    std::atomic<int> next { 0 };
+    std::atomic<int> done { 0 };
+    int count;
+    std::mutex mutex;
+    std::condition_variable condition;
+
+    void run(const std::function<void(int)>& function) {
+        for (int i; (i = next++) < count; ) {
+            function(i);
+            if (++done == count) {
+                std::lock_guard<std::mutex> lock(mutex);
+                condition.notify_all();
+            }
+        }
+    }
+};
+}
+
+void ThreadPool::parallelFor(int count, const std::function<void(int)>& function) {
+    if (count <= 1 || workers.empty()) {
+        for (int i = 0; i < count; i++)
+            function(i);
+        return;
+    }
+
+    // helpers which only start after every item was taken return without touching function
+    auto state = std::make_shared<ParallelForState>();
+    state->count = count;
+
+    int helpers = std::min<int>(count - 1, (int) workers.size());
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (int i = 0; i < helpers; i++)
+            tasks.emplace_back([state, &function] { state->run(function); });
+    }
+    condition.notify_all();
+
+    state->run(function);
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->condition.wait(lock, [&state] { return state->done == state->count; });
+}
+
+int ThreadPool::getThreadCount() const {
+    return (int) workers.size();
+}
+
+ThreadPool& getThreadPool() {
+    static ThreadPool threadPool(std::clamp<int>((int) std::thread::hardware_concurrency() - 1, 1, 4));
+    return threadPool;
+}
+}
\ No newline at end of file
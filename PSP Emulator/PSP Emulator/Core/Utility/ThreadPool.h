@@ -0,0 +1,39 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Core::Utility {
+// small fixed pool for host side work (texture decoding...), never runs guest code
+class ThreadPool {
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool stopping;
+
+    void worker();
+public:
+    explicit ThreadPool(int threadCount);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    std::future<void> submit(std::function<void()> task);
+
+    // runs function(0..count-1) across the pool, the calling thread takes items too
+    // so it always makes progress even when every worker is busy
+    void parallelFor(int count, const std::function<void(int)>& function);
+
+    int getThreadCount() const;
+};
+
+ThreadPool& getThreadPool();
+}
\ No newline at end of file
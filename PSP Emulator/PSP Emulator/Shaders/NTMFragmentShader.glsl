@@ -4,10 +4,15 @@ out vec4 colorOutput;
 
 in vec2 textureCoord;
 in vec4 color;
-in vec4 normal;
 
+#ifdef TEXTURE
 uniform sampler2D texels;
+#endif
 
 void main() {
+#ifdef TEXTURE
 	colorOutput = color * texture(texels, textureCoord);
+#else
+	colorOutput = color;
+#endif
 }
\ No newline at end of file
@@ -1,14 +1,16 @@
 #version 460 core
 
+// THROUGH_MODE, TEXTURE and VERTEX_COLOR are defined by the renderer for each variant
+
 layout (location = 0) in vec3 aPosition;
 layout (location = 1) in vec2 aTextureCoord;
 layout (location = 2) in vec4 aColor;
 layout (location = 3) in vec4 aNormal;
 
-subroutine vec4 VertexProcessor();
-
-subroutine uniform VertexProcessor vertexProcessor;
+out vec2 textureCoord;
+out vec4 color;
 
+#ifdef THROUGH_MODE
 const mat4 throughModeMatrixTranslation = mat4(
      2.0/480.0,  0.0      ,  0.0        ,  0.0,
      0.0      , -2.0/272.0,  0.0        ,  0.0,
@@ -16,25 +18,36 @@ const mat4 throughModeMatrixTranslation = mat4(
     -1.0      ,  1.0      , -1.0        ,  1.0
 );
 
-out vec2 textureCoord;
-out vec4 color;
-out vec4 normal;
-
-uniform mat4 uProjection, uView, uWorld;
 uniform float textureScaleX, textureScaleY;
+#else
+uniform mat4 uProjection, uView, uWorld;
+#endif
 
-subroutine(VertexProcessor) vec4 normalModeVertexProcessor() {
-	textureCoord = aTextureCoord;
-	return uProjection * uView * uWorld * vec4(aPosition, 1);
-}
+#ifndef VERTEX_COLOR
+uniform vec4 materialAmbient;
+#endif
 
-subroutine(VertexProcessor) vec4 throughModeVertexProcessor() {
-	textureCoord = vec2(aTextureCoord.x / textureScaleX, aTextureCoord.y / textureScaleY);
-	return throughModeMatrixTranslation * vec4(aPosition, 1.);
-}
+#ifdef TEXTURE
+// scale and offset of the coordinates, render targets are sampled flipped and at their own size
+uniform vec4 textureTransform;
+#endif
 
 void main() {
+#ifdef VERTEX_COLOR
 	color = aColor;
-	normal = aNormal;
-	gl_Position = vertexProcessor();
+#else
+	color = materialAmbient;
+#endif
+
+#ifdef THROUGH_MODE
+	textureCoord = vec2(aTextureCoord.x / textureScaleX, aTextureCoord.y / textureScaleY);
+	gl_Position = throughModeMatrixTranslation * vec4(aPosition, 1.);
+#else
+	textureCoord = aTextureCoord;
+	gl_Position = uProjection * uView * uWorld * vec4(aPosition, 1);
+#endif
+
+#ifdef TEXTURE
+	textureCoord = textureCoord * textureTransform.xy + textureTransform.zw;
+#endif
 }
\ No newline at end of file
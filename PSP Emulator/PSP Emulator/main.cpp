@@ -20,6 +20,7 @@
 #include <Core/GPU/GPU.h>
 #include <Core/GPU/Renderer.h>
 #include <Core/GPU/DisplayList.h>
+#include <Core/GPU/GPUProfiler.h>
 
 #include <Core/HLE/Modules/sceAtrac3plus.h>
 
@@ -31,6 +32,7 @@
 
 #include <thread>
 #include <mutex>
+#include <cstring>
 
 using namespace Core::Kernel;
 
@@ -87,6 +89,15 @@ void __frontendDestroy() {
 
 bool kernelTrace;
 
+// --gpu-profile <file> writes the GPU profiler counters of every frame as a CSV row
+static const char *__getProfilerOutput(int argc, char *argv[]) {
+    for (int i = 1; i + 1 < argc; i++) {
+        if (!std::strcmp(argv[i], "--gpu-profile"))
+            return argv[i + 1];
+    }
+    return nullptr;
+}
+
 int main(int argc, char *argv[]) {
     SetConsoleTitleW(L"awooga log");
     bool state = Core::Emulator::initialize();
@@ -101,6 +112,10 @@ int main(int argc, char *argv[]) {
     state = Core::Emulator::loadGameProgram();
     // state = false;
     if (state) {
+        if (const char *profilerOutput = __getProfilerOutput(argc, argv); profilerOutput) {
+            Core::GPU::setGPUProfilerEnable(true);
+            Core::GPU::openGPUProfilerCSV(profilerOutput);
+        }
 #if 0
         Core::GPU::setRenderDevice(Core::GPU::createRenderDevice(Core::GPU::RENDERER_TYPE_NONE));
         for (int i = 0; i < 5000; i++) {
@@ -159,6 +174,7 @@ int main(int argc, char *argv[]) {
         Core::GPU::destroyRenderDevice(Core::GPU::getRenderDevice());
         Core::GPU::setRenderDevice(nullptr);
 #endif
+        Core::GPU::closeGPUProfilerCSV();
     } else {
         LOG_ERROR("main", "can't load game program!");
     }
@@ -0,0 +1,112 @@
+#include "Test.h"
+
+#include <Core/GPU/BlockTransfer.h>
+#include <Core/Memory/MemoryAccess.h>
+#include <Core/PSP/MemoryMap.h>
+
+#include <cstring>
+#include <vector>
+
+using namespace Core::GPU;
+
+namespace Core::Memory {
+extern uint8_t *videoMemory;
+}
+
+static constexpr uint32_t vramAddress = 0x04000000;
+
+// every byte of VRAM gets a value that differs from its neighbours so misplaced rows show up
+static std::vector<uint8_t> __fillVideoMemory() {
+    for (uint32_t i = 0; i < Core::PSP::VRAM_MEMORY_SIZE; i++)
+        Core::Memory::videoMemory[i] = uint8_t(i * 7 + (i >> 8));
+    return std::vector<uint8_t>(Core::Memory::videoMemory, Core::Memory::videoMemory + Core::PSP::VRAM_MEMORY_SIZE);
+}
+
+// the expected VRAM contents, rows copied from the snapshot taken before the transfer
+static std::vector<uint8_t> __transferReference(const std::vector<uint8_t>& before, const GPUState::TransferInfo& info) {
+    std::vector<uint8_t> after = before;
+    const uint32_t rowSize = info.width * info.pixelSize;
+    for (uint32_t y = 0; y < info.height; y++) {
+        uint32_t source = info.sourceAddress - vramAddress + ((info.sourceY + y) * info.sourceBufferWidth + info.sourceX) * info.pixelSize;
+        uint32_t destination = info.destinationAddress - vramAddress + ((info.destinationY + y) * info.destinationBufferWidth + info.destinationX) * info.pixelSize;
+        std::memcpy(after.data() + destination, before.data() + source, rowSize);
+    }
+    return after;
+}
+
+static bool __isVideoMemory(const std::vector<uint8_t>& expected) {
+    return std::memcmp(Core::Memory::videoMemory, expected.data(), expected.size()) == 0;
+}
+
+TEST(copiesRectangleBetweenStrides) {
+    GPUState::TransferInfo info {
+        .sourceAddress = vramAddress, .destinationAddress = vramAddress + 0x100000,
+        .sourceBufferWidth = 512, .destinationBufferWidth = 64,
+        .sourceX = 13, .sourceY = 7, .destinationX = 5, .destinationY = 3,
+        .width = 37, .height = 19, .pixelSize = 4
+    };
+
+    std::vector<uint8_t> before = __fillVideoMemory();
+    CHECK(__executeBlockTransfer(info));
+    CHECK(__isVideoMemory(__transferReference(before, info)));
+    return true;
+}
+
+TEST(copiesContiguousRows) {
+    GPUState::TransferInfo info {
+        .sourceAddress = vramAddress + 0x200000, .destinationAddress = vramAddress,
+        .sourceBufferWidth = 480, .destinationBufferWidth = 480,
+        .sourceX = 0, .sourceY = 10, .destinationX = 0, .destinationY = 2,
+        .width = 480, .height = 32, .pixelSize = 2
+    };
+
+    std::vector<uint8_t> before = __fillVideoMemory();
+    CHECK(__executeBlockTransfer(info));
+    CHECK(__isVideoMemory(__transferReference(before, info)));
+    return true;
+}
+
+TEST(copiesOverlappingRectangleDownwards) {
+    // the destination starts two rows below the source in the same buffer
+    GPUState::TransferInfo info {
+        .sourceAddress = vramAddress, .destinationAddress = vramAddress,
+        .sourceBufferWidth = 128, .destinationBufferWidth = 128,
+        .sourceX = 4, .sourceY = 1, .destinationX = 6, .destinationY = 3,
+        .width = 64, .height = 40, .pixelSize = 2
+    };
+
+    std::vector<uint8_t> before = __fillVideoMemory();
+    CHECK(__executeBlockTransfer(info));
+    CHECK(__isVideoMemory(__transferReference(before, info)));
+    return true;
+}
+
+TEST(marksDestinationWritten) {
+    GPUState::TransferInfo info {
+        .sourceAddress = vramAddress, .destinationAddress = vramAddress + 0x100000,
+        .sourceBufferWidth = 64, .destinationBufferWidth = 64,
+        .sourceX = 0, .sourceY = 0, .destinationX = 0, .destinationY = 0,
+        .width = 64, .height = 16, .pixelSize = 4
+    };
+
+    __fillVideoMemory();
+    uint64_t stamp = Core::Memory::takeWriteStamp();
+    CHECK(__executeBlockTransfer(info));
+    CHECK(Core::Memory::isWrittenSince(info.destinationAddress, 64 * 16 * 4, stamp));
+    CHECK(!Core::Memory::isWrittenSince(info.sourceAddress, 64 * 16 * 4, stamp));
+    return true;
+}
+
+TEST(rejectsTransferPastVideoMemory) {
+    GPUState::TransferInfo info {
+        .sourceAddress = vramAddress, .destinationAddress = vramAddress + 0x3FF000,
+        .sourceBufferWidth = 512, .destinationBufferWidth = 512,
+        .sourceX = 0, .sourceY = 0, .destinationX = 0, .destinationY = 0,
+        .width = 512, .height = 8, .pixelSize = 4
+    };
+
+    std::vector<uint8_t> before = __fillVideoMemory();
+    CHECK(!__executeBlockTransfer(info));
+    CHECK(__isVideoMemory(before));
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,175 @@
+#include "Test.h"
+#include "TestStubs.h"
+
+#include <Core/GPU/GPU.h>
+#include <Core/GPU/Culling.h>
+#include <Core/GPU/GEConstants.h>
+
+#include <vector>
+
+using namespace Core::GPU;
+
+// every matrix is identity, clip space is the position with w = 1
+static const float identity[16] = { 1.f, 0.f, 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 0.f, 1.f };
+
+static VertexData __getVertex(float x, float y, float z = 0.f) {
+    VertexData vertex {};
+    vertex.position = glm::vec3(x, y, z);
+    return vertex;
+}
+
+// a small counter clockwise triangle around (x, y), clockwise when flipped
+static void __addTriangle(std::vector<VertexData>& vertices, float x, float y, bool flipped = false) {
+    vertices.push_back(__getVertex(x, y));
+    vertices.push_back(__getVertex(flipped ? x : x + 0.01f, flipped ? y + 0.01f : y));
+    vertices.push_back(__getVertex(flipped ? x + 0.01f : x, flipped ? y : y + 0.01f));
+}
+
+static float __getWindingArea(const VertexData& a, const VertexData& b, const VertexData& c) {
+    return (b.position.x - a.position.x) * (c.position.y - a.position.y) - (c.position.x - a.position.x) * (b.position.y - a.position.y);
+}
+
+TEST(combinesClipMatrix) {
+    GPUState state {};
+    state.worldMatrix.mData[12] = 2.f; // translate x
+    state.viewMatrix.mData[5] = 3.f; // scale y
+    state.projectionMatrix.mData[14] = -1.f; // translate z
+
+    float clipMatrix[16];
+    __getClipMatrix(&state, clipMatrix);
+
+    static const float expected[16] = { 1.f, 0.f, 0.f, 0.f, 0.f, 3.f, 0.f, 0.f, 0.f, 0.f, 1.f, 0.f, 2.f, 0.f, -1.f, 1.f };
+    for (int i = 0; i < 16; i++)
+        CHECK_NEAR(clipMatrix[i], expected[i], 1e-6f);
+    return true;
+}
+
+TEST(computesCommonClipOutcode) {
+    const VertexData right[3] = { __getVertex(1.5f, 0.f), __getVertex(2.f, 0.5f), __getVertex(3.f, -0.5f) };
+    CHECK(__getCommonClipOutcode(identity, right, 3) == CLIP_RIGHT);
+
+    const VertexData bottomLeft[2] = { __getVertex(-2.f, -2.f), __getVertex(-1.5f, -3.f) };
+    CHECK(__getCommonClipOutcode(identity, bottomLeft, 2) == (CLIP_LEFT | CLIP_BOTTOM));
+
+    const VertexData behind[2] = { __getVertex(0.f, 0.f, -2.f), __getVertex(0.5f, 0.f, -1.5f) };
+    CHECK(__getCommonClipOutcode(identity, behind, 2) == CLIP_NEAR);
+
+    // the far plane is never tested
+    const VertexData beyondFar[2] = { __getVertex(0.f, 0.f, 2.f), __getVertex(0.5f, 0.f, 3.f) };
+    CHECK(__getCommonClipOutcode(identity, beyondFar, 2) == 0);
+
+    // outside on opposite sides is still potentially visible
+    const VertexData straddling[2] = { __getVertex(-2.f, 0.f), __getVertex(2.f, 0.f) };
+    CHECK(__getCommonClipOutcode(identity, straddling, 2) == 0);
+    return true;
+}
+
+TEST(testsBoundingBox) {
+    GPUState state {};
+    Tests::vertexList = DecodedVertexList {};
+    Tests::vertexList.vertices = { __getVertex(0.f, 2.f), __getVertex(0.5f, 1.5f) };
+    CHECK(!__isBoundingBoxVisible(&state, 2));
+
+    Tests::vertexList.vertices.push_back(__getVertex(0.f, 0.f));
+    CHECK(__isBoundingBoxVisible(&state, 3));
+
+    // through mode coordinates are never clipped
+    Tests::vertexList.vertices.pop_back();
+    state.vertexInfo.tm = 1;
+    CHECK(__isBoundingBoxVisible(&state, 2));
+    return true;
+}
+
+TEST(rejectsDrawOutsideClipVolume) {
+    GPUState state {};
+    DecodedVertexList in {}, out {};
+    __addTriangle(in.vertices, 1.5f, 0.f);
+    __addTriangle(in.vertices, 2.5f, 0.5f);
+    CHECK(__cullVertexList(&state, GE_PRIM_TRIANGLES, in, out) == CULL_ALL);
+
+    __addTriangle(in.vertices, 0.f, 0.f);
+    CHECK(__cullVertexList(&state, GE_PRIM_TRIANGLES, in, out) == CULL_NONE);
+
+    // through mode and clear mode draws are left alone
+    in.vertices.resize(6);
+    state.vertexInfo.tm = 1;
+    CHECK(__cullVertexList(&state, GE_PRIM_TRIANGLES, in, out) == CULL_NONE);
+    state.vertexInfo.tm = 0;
+    state.clearModeEnable = true;
+    CHECK(__cullVertexList(&state, GE_PRIM_TRIANGLES, in, out) == CULL_NONE);
+    return true;
+}
+
+TEST(compactsOffscreenTriangles) {
+    GPUState state {};
+    DecodedVertexList in {}, out {};
+
+    // every fourth triangle is on screen
+    for (int i = 0; i < 200; i++)
+        __addTriangle(in.vertices, i % 4 == 0 ? 0.f : 1.5f + i * 0.01f, 0.f);
+
+    CHECK(__cullVertexList(&state, GE_PRIM_TRIANGLES, in, out) == CULL_COMPACTED);
+    CHECK(out.indexType == 0);
+    CHECK(out.vertices.size() == 50 * 3);
+    for (size_t i = 0; i < out.vertices.size(); i += 3)
+        CHECK(__getCommonClipOutcode(identity, &out.vertices[i], 3) == 0);
+    return true;
+}
+
+TEST(compactsIndexedTriangles) {
+    GPUState state {};
+    DecodedVertexList in {}, out {};
+
+    // the triangles are read back to front through the indices, the first half is on screen
+    std::vector<uint16_t> indices;
+    for (int i = 0; i < 200; i++) {
+        __addTriangle(in.vertices, i < 100 ? 3.f : 0.f, 0.f);
+        indices.insert(indices.begin(), { uint16_t(i * 3), uint16_t(i * 3 + 1), uint16_t(i * 3 + 2) });
+    }
+    in.indices.resize(indices.size() * sizeof(uint16_t));
+    std::copy(indices.begin(), indices.end(), (uint16_t *) in.indices.data());
+    in.indexType = 2;
+    in.indexCount = int(indices.size());
+
+    CHECK(__cullVertexList(&state, GE_PRIM_TRIANGLES, in, out) == CULL_COMPACTED);
+    CHECK(out.indexType == 2);
+    CHECK(out.indexCount == 100 * 3);
+    CHECK(out.vertices.size() == in.vertices.size());
+
+    // the order of the remaining triangles is kept
+    const uint16_t *compacted = (const uint16_t *) out.indices.data();
+    for (int i = 0; i < out.indexCount; i++)
+        CHECK(compacted[i] == indices[i]);
+    return true;
+}
+
+TEST(compactsBackFacingTriangles) {
+    GPUState state {};
+    state.cullingEnable = true;
+
+    for (bool clockwise : { false, true }) {
+        state.cullingFaceDirection = clockwise;
+        DecodedVertexList in {}, out {};
+        for (int i = 0; i < 200; i++)
+            __addTriangle(in.vertices, -0.5f + i * 0.005f, 0.f, i % 2 == 1);
+
+        CHECK(__cullVertexList(&state, GE_PRIM_TRIANGLES, in, out) == CULL_COMPACTED);
+        CHECK(out.vertices.size() == 100 * 3);
+        for (size_t i = 0; i < out.vertices.size(); i += 3) {
+            float area = __getWindingArea(out.vertices[i], out.vertices[i + 1], out.vertices[i + 2]);
+            CHECK(clockwise ? area < 0.f : area > 0.f);
+        }
+    }
+    return true;
+}
+
+TEST(keepsMostlyVisibleList) {
+    // a few triangles culled isn't worth a copy of the list
+    GPUState state {};
+    DecodedVertexList in {}, out {};
+    for (int i = 0; i < 200; i++)
+        __addTriangle(in.vertices, i % 10 == 0 ? 2.f : 0.f, 0.f);
+
+    CHECK(__cullVertexList(&state, GE_PRIM_TRIANGLES, in, out) == CULL_NONE);
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,64 @@
+#include "Test.h"
+
+#include <Core/GPU/DXTBlock.h>
+
+using namespace Core::GPU;
+
+// a DXT5 block with red, blue and both mixes on every row and each of the eight alphas used twice
+static const uint8_t dxt5Block[16] = {
+    0xE4, 0xE4, 0xE4, 0xE4, 0x00, 0xF8, 0x1F, 0x00, // color indices 0 to 3 on every row, red, blue
+    0x88, 0xC6, 0xFA, 0x88, 0xC6, 0xFA, 0xFF, 0x00 // alpha indices 0 to 7 twice, alpha 255 and 0
+};
+
+TEST(decodesDXT5Block) {
+    static const uint32_t golden[16] = {
+        0xFF0000FF, 0x00FF0000, 0xDA5500AA, 0xB6AA0055,
+        0x910000FF, 0x6DFF0000, 0x485500AA, 0x24AA0055,
+        0xFF0000FF, 0x00FF0000, 0xDA5500AA, 0xB6AA0055,
+        0x910000FF, 0x6DFF0000, 0x485500AA, 0x24AA0055
+    };
+
+    uint32_t pixels[16];
+    __decodeDXTBlock<GE_TFMT_DXT5>(dxt5Block, pixels, 4);
+    for (int i = 0; i < 16; i++)
+        CHECK(pixels[i] == golden[i]);
+    return true;
+}
+
+TEST(convertsDXT5BlockToS3TC) {
+    static const uint8_t golden[16] = {
+        0xFF, 0x00, 0x88, 0xC6, 0xFA, 0x88, 0xC6, 0xFA,
+        0x00, 0xF8, 0x1F, 0x00, 0xE4, 0xE4, 0xE4, 0xE4
+    };
+
+    uint8_t s3tc[16];
+    __convertDXTBlock<GE_TFMT_DXT5>(dxt5Block, s3tc);
+    CHECK(std::memcmp(s3tc, golden, sizeof golden) == 0);
+    return true;
+}
+
+TEST(decodesDXT1TransparentBlock) {
+    // color1 <= color2 switches to three colors and transparent black, the rows use indices 3, 2, 1, 0
+    static const uint8_t block[8] = { 0x1B, 0x1B, 0x1B, 0x1B, 0x1F, 0x00, 0x00, 0xF8 };
+    static const uint32_t golden[4] = { 0x00000000, 0xFF7F007F, 0xFF0000FF, 0xFFFF0000 };
+
+    uint32_t pixels[16];
+    __decodeDXTBlock<GE_TFMT_DXT1>(block, pixels, 4);
+    for (int i = 0; i < 16; i++)
+        CHECK(pixels[i] == golden[i & 3]);
+    return true;
+}
+
+TEST(decodesDXT3Alpha) {
+    // 4 bit alphas 0 to 15 in row order, colors all index 0 (white)
+    static const uint8_t block[16] = {
+        0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x00, 0x00,
+        0x10, 0x32, 0x54, 0x76, 0x98, 0xBA, 0xDC, 0xFE
+    };
+
+    uint32_t pixels[16];
+    __decodeDXTBlock<GE_TFMT_DXT3>(block, pixels, 4);
+    for (int i = 0; i < 16; i++)
+        CHECK(pixels[i] == ((uint32_t(i * 0x11) << 24) | 0x00FFFFFF));
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,207 @@
+#include "Test.h"
+#include "TestStubs.h"
+
+#include <Core/GPU/GPU.h>
+#include <Core/GPU/Tessellation.h>
+#include <Core/GPU/GEConstants.h>
+
+#include <vector>
+
+using namespace Core::GPU;
+
+// a control mesh with no two points alike, row by row like the GE reads it
+static void __setControlMesh(int ucount, int vcount) {
+    Tests::vertexList = DecodedVertexList {};
+    for (int j = 0; j < vcount; j++) {
+        for (int i = 0; i < ucount; i++) {
+            VertexData vertex {};
+            vertex.position = glm::vec3(i + 0.25f * ((i * 7 + j) % 5), j * 2.f - (i + j) % 3, 0.5f * ((i * j) % 4));
+            vertex.uv = glm::vec2(i * 0.1f, j * 0.2f + (i % 2) * 0.05f);
+            vertex.color = glm::vec4(float(i) / ucount, float(j) / vcount, 0.5f, 1.f - 0.1f * (i % 3));
+            vertex.normal = glm::vec3(0.1f * (j % 3), 0.2f * (i % 2), 1.f);
+            Tests::vertexList.vertices.push_back(vertex);
+        }
+    }
+}
+
+static GPUState __getPatchState(int divisionS, int divisionT, uint8_t primitive, bool face, bool textured) {
+    GPUState state {};
+    state.vertexInfo.tt = textured ? 1 : 0;
+    state.patchInfo.divisionS = uint8_t(divisionS);
+    state.patchInfo.divisionT = uint8_t(divisionT);
+    state.patchInfo.primitive = primitive;
+    state.patchInfo.face = face;
+    return state;
+}
+
+static uint32_t __getPatchParam(int ucount, int vcount, int utype, int vtype) {
+    return uint32_t(ucount) | uint32_t(vcount) << 8 | uint32_t(utype) << 16 | uint32_t(vtype) << 18;
+}
+
+// one sample along u or v of the scalar reference, the weights of four consecutive control points
+struct ReferenceSample {
+    int first;
+    float weights[4];
+};
+
+static std::vector<ReferenceSample> __getBezierSamples(int count, int divisions) {
+    const int patches = (count - 1) / 3;
+    std::vector<ReferenceSample> samples;
+    for (int patch = 0; patch < patches; patch++) {
+        for (int d = patch == 0 ? 0 : 1; d <= divisions; d++) {
+            const float t = float(d) / divisions, s = 1.f - t;
+            samples.push_back(ReferenceSample { patch * 3, { s * s * s, 3.f * t * s * s, 3.f * t * t * s, t * t * t } });
+        }
+    }
+    return samples;
+}
+
+// uniform cubic b-spline, the basis matrix applied to the four control points of each span
+static std::vector<ReferenceSample> __getUniformSplineSamples(int count, int divisions) {
+    const int patches = count - 3;
+    std::vector<ReferenceSample> samples;
+    for (int patch = 0; patch < patches; patch++) {
+        for (int d = patch == 0 ? 0 : 1; d <= divisions; d++) {
+            const float t = float(d) / divisions, s = 1.f - t;
+            samples.push_back(ReferenceSample { patch, {
+                s * s * s / 6.f,
+                (3.f * t * t * t - 6.f * t * t + 4.f) / 6.f,
+                (-3.f * t * t * t + 3.f * t * t + 3.f * t + 1.f) / 6.f,
+                t * t * t / 6.f
+            } });
+        }
+    }
+    return samples;
+}
+
+// the tensor product of the u and v samples, evaluated one attribute at a time
+static bool __matchesReference(const TessellatedPatch& patch, int ucount, const std::vector<ReferenceSample>& uSamples,
+                               const std::vector<ReferenceSample>& vSamples) {
+    const std::vector<VertexData>& points = Tests::vertexList.vertices;
+    CHECK(patch.data.vertices.size() == uSamples.size() * vSamples.size());
+
+    for (size_t y = 0; y < vSamples.size(); y++) {
+        for (size_t x = 0; x < uSamples.size(); x++) {
+            VertexData expected {};
+            for (int j = 0; j < 4; j++) {
+                for (int i = 0; i < 4; i++) {
+                    const VertexData& point = points[size_t(vSamples[y].first + j) * ucount + uSamples[x].first + i];
+                    const float weight = uSamples[x].weights[i] * vSamples[y].weights[j];
+                    for (int k = 0; k < 3; k++) {
+                        expected.position[k] += point.position[k] * weight;
+                        expected.normal[k] += point.normal[k] * weight;
+                    }
+                    for (int k = 0; k < 2; k++)
+                        expected.uv[k] += point.uv[k] * weight;
+                    for (int k = 0; k < 4; k++)
+                        expected.color[k] += point.color[k] * weight;
+                }
+            }
+
+            const VertexData& vertex = patch.data.vertices[y * uSamples.size() + x];
+            for (int k = 0; k < 3; k++) {
+                CHECK_NEAR(vertex.position[k], expected.position[k], 1e-4f);
+                CHECK_NEAR(vertex.normal[k], expected.normal[k], 1e-4f);
+            }
+            for (int k = 0; k < 2; k++)
+                CHECK_NEAR(vertex.uv[k], expected.uv[k], 1e-4f);
+            for (int k = 0; k < 4; k++)
+                CHECK_NEAR(vertex.color[k], expected.color[k], 1e-4f);
+        }
+    }
+    return true;
+}
+
+TEST(tessellatesBezierPatches) {
+    // two patches along u sharing their edge, one along v
+    __clearTessellationCache();
+    __setControlMesh(7, 4);
+    GPUState state = __getPatchState(5, 3, 0, false, true);
+
+    const TessellatedPatch *patch = __getTessellatedPatch(&state, false, __getPatchParam(7, 4, 0, 0));
+    CHECK(patch != nullptr);
+    CHECK(__matchesReference(*patch, 7, __getBezierSamples(7, 5), __getBezierSamples(4, 3)));
+    return true;
+}
+
+TEST(tessellatesUniformSplines) {
+    __clearTessellationCache();
+    __setControlMesh(6, 5);
+    GPUState state = __getPatchState(4, 3, 0, false, true);
+
+    const TessellatedPatch *patch = __getTessellatedPatch(&state, true, __getPatchParam(6, 5, 0, 0));
+    CHECK(patch != nullptr);
+    CHECK(__matchesReference(*patch, 6, __getUniformSplineSamples(6, 4), __getUniformSplineSamples(5, 3)));
+    return true;
+}
+
+TEST(openSplineReachesCornerPoints) {
+    __clearTessellationCache();
+    __setControlMesh(5, 6);
+    GPUState state = __getPatchState(3, 2, 0, false, true);
+
+    const TessellatedPatch *patch = __getTessellatedPatch(&state, true, __getPatchParam(5, 6, 3, 3));
+    CHECK(patch != nullptr);
+
+    const std::vector<VertexData>& points = Tests::vertexList.vertices;
+    const VertexData& first = patch->data.vertices.front();
+    const VertexData& last = patch->data.vertices.back();
+    for (int k = 0; k < 3; k++) {
+        CHECK_NEAR(first.position[k], points.front().position[k], 1e-4f);
+        CHECK_NEAR(last.position[k], points.back().position[k], 1e-4f);
+    }
+    return true;
+}
+
+TEST(usesPatchParametersWithoutTextureCoordinates) {
+    __clearTessellationCache();
+    __setControlMesh(7, 4);
+    GPUState state = __getPatchState(2, 2, 0, false, false);
+
+    const TessellatedPatch *patch = __getTessellatedPatch(&state, false, __getPatchParam(7, 4, 0, 0));
+    CHECK(patch != nullptr);
+
+    // 5 columns over two patches and 3 rows over one
+    CHECK(patch->data.vertices.size() == 15);
+    for (int y = 0; y < 3; y++) {
+        for (int x = 0; x < 5; x++) {
+            CHECK_NEAR(patch->data.vertices[y * 5 + x].uv[0], x * 0.5f, 1e-6f);
+            CHECK_NEAR(patch->data.vertices[y * 5 + x].uv[1], y * 0.5f, 1e-6f);
+        }
+    }
+    return true;
+}
+
+TEST(generatesPatchTriangles) {
+    __clearTessellationCache();
+    __setControlMesh(4, 4);
+
+    for (bool face : { false, true }) {
+        GPUState state = __getPatchState(4, 2, 0, face, true);
+        const TessellatedPatch *patch = __getTessellatedPatch(&state, false, __getPatchParam(4, 4, 0, 0));
+        CHECK(patch != nullptr);
+
+        // 5x3 vertices, two triangles per quad
+        CHECK(patch->primitiveType == GE_PRIM_TRIANGLES);
+        CHECK(patch->data.indexType == 2);
+        CHECK(patch->count == 4 * 2 * 6);
+
+        const uint16_t *indices = (const uint16_t *) patch->data.indices.data();
+        for (int i = 0; i < patch->count; i++)
+            CHECK(indices[i] < patch->data.vertices.size());
+
+        // the face bit swaps the second and third vertex of every triangle
+        CHECK(indices[0] == 0);
+        CHECK(indices[1] == (face ? 5 : 1));
+        CHECK(indices[2] == (face ? 1 : 5));
+    }
+    return true;
+}
+
+TEST(rejectsMalformedBezierMesh) {
+    __clearTessellationCache();
+    __setControlMesh(5, 4);
+    GPUState state = __getPatchState(2, 2, 0, false, true);
+    CHECK(__getTessellatedPatch(&state, false, __getPatchParam(5, 4, 0, 0)) == nullptr);
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdio>
+#include <cmath>
+
+// every TEST registers itself before main, a failing CHECK stops the test it's in
+namespace Tests {
+typedef bool (*TestFunction)();
+
+struct TestRegistration {
+    TestRegistration(const char *name, TestFunction function);
+};
+
+int runAll();
+}
+
+#define TEST(name) \
+    static bool name(); \
+    static Tests::TestRegistration name##Registration(#name, name); \
+    static bool name()
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            std::printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            return false; \
+        } \
+    } while (0)
+
+#define CHECK_NEAR(a, b, epsilon) CHECK(std::fabs((a) - (b)) <= (epsilon))
\ No newline at end of file
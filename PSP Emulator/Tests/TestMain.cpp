@@ -0,0 +1,35 @@
+#include "Test.h"
+
+#include <vector>
+
+namespace Tests {
+struct RegisteredTest {
+    const char *name;
+    TestFunction function;
+};
+
+static std::vector<RegisteredTest>& __getTests() {
+    static std::vector<RegisteredTest> tests;
+    return tests;
+}
+
+TestRegistration::TestRegistration(const char *name, TestFunction function) {
+    __getTests().push_back(RegisteredTest { .name = name, .function = function });
+}
+
+int runAll() {
+    int failed = 0;
+    for (const RegisteredTest& test : __getTests()) {
+        bool passed = test.function();
+        std::printf("[%s] %s\n", passed ? "PASS" : "FAIL", test.name);
+        failed += !passed;
+    }
+
+    std::printf("%zu tests, %d failed\n", __getTests().size(), failed);
+    return failed;
+}
+}
+
+int main() {
+    return Tests::runAll() != 0 ? 1 : 0;
+}
\ No newline at end of file
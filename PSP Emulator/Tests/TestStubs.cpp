@@ -0,0 +1,42 @@
+#include "TestStubs.h"
+
+#include <Core/GPU/GPUProfiler.h>
+#include <Core/Memory/MemoryAccess.h>
+#include <Core/PSP/MemoryMap.h>
+
+#include <Core/Logger.h>
+
+#include <vector>
+
+// the tests link single modules of the emulator, these stand in for the parts around them
+
+namespace Tests {
+Core::GPU::DecodedVertexList vertexList;
+}
+
+namespace Core::GPU {
+bool profilerEnabled;
+GPUFrameStatistics profilerFrame;
+
+const DecodedVertexList *__getListFromVertexCache(const GPUState *state, int type, int count) {
+    return &Tests::vertexList;
+}
+}
+
+namespace Core::Logger {
+void print(const std::string& type, Level level, const std::string& file, int line, std::source_location loc, const char *format, ...) {
+}
+}
+
+namespace Core::Memory {
+// plain heap buffers in place of the reserved guest memory
+static std::vector<uint8_t> scratchpadBuffer(Core::PSP::SCRATCHPAD_MEMORY_SIZE);
+static std::vector<uint8_t> userMemoryBuffer(Core::PSP::USERSPACE_MEMORY_SIZE);
+static std::vector<uint8_t> kernelMemoryBuffer(Core::PSP::KERNELSPACE_MEMORY_SIZE);
+static std::vector<uint8_t> videoMemoryBuffer(Core::PSP::VRAM_MEMORY_SIZE);
+
+uint8_t *scratchpad = scratchpadBuffer.data();
+uint8_t *userMemory = userMemoryBuffer.data();
+uint8_t *kernelMemory = kernelMemoryBuffer.data();
+uint8_t *videoMemory = videoMemoryBuffer.data();
+}
\ No newline at end of file
@@ -0,0 +1,8 @@
+#pragma once
+
+#include <Core/GPU/VertexDecoder.h>
+
+namespace Tests {
+// what the stubbed __getListFromVertexCache hands back, whatever the draw asks for
+extern Core::GPU::DecodedVertexList vertexList;
+}
\ No newline at end of file